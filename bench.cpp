@@ -0,0 +1,351 @@
+// Throughput and latency of format_from against sscanf, std::regex and iostreams over the same records.
+//
+//     g++ -std=c++23 -O2 -march=native bench.cpp -o bench && ./bench [records] [repetitions]
+//
+// -march=native matters: the AVX2 loops of format_from are only compiled in for a target that has AVX2, without
+// it the numbers are those of the SSE2/SSSE3 paths (see SIMD in README.md).
+// Every workload is generated from a fixed seed, so runs on the same machine scan identical bytes. Throughput is
+// the best of the repetitions, latency percentiles come from one extra pass that times each record on its own.
+// Matching checksums show that all engines read the same values.
+#include <array>
+#include <chrono>
+#include <cstdio>
+#include <iostream>
+#include <random>
+#include <regex>
+#include <sstream>
+
+#include "format_from.hpp"
+
+namespace {
+
+using c_text = std::array<char, 64>;
+
+struct checksum {
+    double      num   = 0;
+    std::size_t chars = 0;
+
+    template <typename Ty> requires std::is_arithmetic_v<Ty>
+    void add(Ty v)                { num += static_cast<double>(v); }
+    void add(std::string_view s)  { chars += s.size(); }
+    void add(const c_text& s)     { chars += std::strlen(s.data()); }
+
+    bool operator==(const checksum&) const = default;
+};
+
+template <typename Ty> Ty*   c_arg(Ty& v)     { return &v; }
+char*                        c_arg(c_text& s) { return s.data(); }
+
+template <typename Ty>
+void assign_match(const std::csub_match& m, Ty& v) {
+    if constexpr (std::is_same_v<Ty, std::string>) { v = m.str(); }
+    else                                           { std::from_chars(m.first, m.second, v); }
+}
+
+std::string random_word(std::mt19937_64& g) {
+    std::string w(4 + g() % 13, ' ');
+    for (auto& c : w) { c = static_cast<char>('a' + g() % 26); }
+    return w;
+}
+
+std::string random_double(std::mt19937_64& g) {
+    char buf[32];
+    const double v = std::ldexp(static_cast<double>(g() >> 11), -static_cast<int>(g() % 60)) * (g() % 2 ? 1 : -1);
+    return { buf, std::to_chars(buf, buf + sizeof(buf), v).ptr };
+}
+
+// A workload is a record generator plus the same record layout spelled for every engine.
+struct int_workload {
+    static constexpr const char*      name      = "int";
+    static constexpr std::string_view pattern   = "{} {} {} {}";
+    static constexpr const char*      scanf_fmt = " %d %d %d %d";
+    static constexpr const char*      regex_src = R"((-?\d+) (-?\d+) (-?\d+) (-?\d+))";
+    template <typename Text> using record = std::tuple<int, int, int, int>;
+
+    static void make(std::mt19937_64& g, std::string& out) {
+        for (int k = 0; k < 4; ++k) {
+            out += std::to_string(static_cast<long long>(g() % 2000000001) - 1000000000);
+            out += k == 3 ? '\n' : ' ';
+        }
+    }
+    static bool read(std::istream& in, record<std::string>& r) {
+        return static_cast<bool>(in >> std::get<0>(r) >> std::get<1>(r) >> std::get<2>(r) >> std::get<3>(r));
+    }
+};
+
+struct float_workload {
+    static constexpr const char*      name      = "float";
+    static constexpr std::string_view pattern   = "{} {} {} {}";
+    static constexpr const char*      scanf_fmt = " %lf %lf %lf %lf";
+    static constexpr const char*      regex_src = R"((\S+) (\S+) (\S+) (\S+))";
+    template <typename Text> using record = std::tuple<double, double, double, double>;
+
+    static void make(std::mt19937_64& g, std::string& out) {
+        for (int k = 0; k < 4; ++k) { out += random_double(g); out += k == 3 ? '\n' : ' '; }
+    }
+    static bool read(std::istream& in, record<std::string>& r) {
+        return static_cast<bool>(in >> std::get<0>(r) >> std::get<1>(r) >> std::get<2>(r) >> std::get<3>(r));
+    }
+};
+
+struct string_workload {
+    static constexpr const char*      name      = "string";
+    static constexpr std::string_view pattern   = "{} {} {}";
+    static constexpr const char*      scanf_fmt = " %63s %63s %63s";
+    static constexpr const char*      regex_src = R"((\S+) (\S+) (\S+))";
+    template <typename Text> using record = std::tuple<Text, Text, Text>;
+
+    static void make(std::mt19937_64& g, std::string& out) {
+        out += random_word(g) + ' ' + random_word(g) + ' ' + random_word(g) + '\n';
+    }
+    static bool read(std::istream& in, record<std::string>& r) {
+        return static_cast<bool>(in >> std::get<0>(r) >> std::get<1>(r) >> std::get<2>(r));
+    }
+};
+
+struct mixed_workload {
+    static constexpr const char*      name      = "mixed";
+    static constexpr std::string_view pattern   = "[INFO] request id={} took {}ms user={}";
+    static constexpr const char*      scanf_fmt = " [INFO] request id=%llu took %lfms user=%63s";
+    static constexpr const char*      regex_src = R"(\[INFO\] request id=(\d+) took ([0-9.]+)ms user=(\S+))";
+    template <typename Text> using record = std::tuple<unsigned long long, double, Text>;
+
+    static void make(std::mt19937_64& g, std::string& out) {
+        char ms[16];
+        std::snprintf(ms, sizeof(ms), "%.3f", static_cast<double>(g() % 100000) / 1000);
+        out += "[INFO] request id=" + std::to_string(g() % 10000000000000ull) + " took " + ms + "ms user=" + random_word(g) + '\n';
+    }
+    static bool read(std::istream& in, record<std::string>& r) {
+        in >> std::ws;
+        in.ignore(18) >> std::get<0>(r);
+        in.ignore(6)  >> std::get<1>(r);
+        in.ignore(8)  >> std::get<2>(r);
+        return static_cast<bool>(in);
+    }
+};
+
+struct input {
+    std::string                   text;
+    std::string                   ctext;  // Records separated by '\0' so sscanf doesn't run strlen over everything.
+    std::vector<std::string_view> lines;
+    std::vector<const char*>      clines;
+};
+
+template <class W>
+input make_input(std::size_t records) {
+    std::mt19937_64 g{ 20240501 };
+    input in;
+    for (std::size_t i = 0; i < records; ++i) { W::make(g, in.text); }
+    in.ctext = in.text;
+    std::ranges::replace(in.ctext, '\n', '\0');
+    for (std::size_t b = 0; b < in.text.size();) {
+        const auto e = in.text.find('\n', b);
+        in.lines.emplace_back(in.text.data() + b, e - b);
+        in.clines.push_back(in.ctext.data() + b);
+        b = e + 1;
+    }
+    return in;
+}
+
+template <class Record>
+void add_record(checksum& sum, const Record& r) {
+    std::apply([&](const auto& ... f) { (sum.add(f), ...); }, r);
+}
+
+template <class Columns>
+checksum columns_checksum(const Columns& out) {
+    checksum sum;
+    std::apply([&](const auto& ... col) { (..., [&] { for (const auto& v : col) { sum.add(v); } }()); }, out.columns);
+    return sum;
+}
+
+// scan_lines with the column types of W's record, Text for the string fields.
+template <class W, typename Text, class Rng>
+auto scan_lines_of(Rng&& rng) {
+    return [&]<typename ... Args>(std::tuple<Args...>*) {
+        return scan_lines<Args...>(std::forward<Rng>(rng), W::pattern);
+    }(static_cast<typename W::template record<Text>*>(nullptr));
+}
+
+// Per record engines, each scans one line of the input and folds what it read into sum.
+template <class W>
+void line_format_from(const input& in, std::size_t i, checksum& sum) {
+    typename W::template record<std::string_view> r{};
+    std::apply([&](auto& ... f) { return format_from(in.lines[i], W::pattern, f...); }, r);
+    add_record(sum, r);
+}
+
+template <class W>
+void line_vscan(const input& in, std::size_t i, checksum& sum) {
+    typename W::template record<std::string_view> r{};
+    std::apply([&](auto& ... f) {
+        auto store = std::p1729r3::make_scan_arg_store<std::string_view>(f...);
+        return std::p1729r3::vscan(std::string_view{ in.lines[i] }, W::pattern, std::p1729r3::make_scan_args(store));
+    }, r);
+    add_record(sum, r);
+}
+
+template <class W>
+void line_sscanf(const input& in, std::size_t i, checksum& sum) {
+    typename W::template record<c_text> r{};
+    std::apply([&](auto& ... f) { return std::sscanf(in.clines[i], W::scanf_fmt, c_arg(f)...); }, r);
+    add_record(sum, r);
+}
+
+template <class W>
+void line_regex(const input& in, std::size_t i, checksum& sum) {
+    static const std::regex re{ W::regex_src, std::regex::optimize };
+    typename W::template record<std::string> r{};
+    std::cmatch m;
+    if (std::regex_match(in.lines[i].data(), in.lines[i].data() + in.lines[i].size(), m, re)) {
+        [&]<std::size_t ... I>(std::index_sequence<I...>) {
+            (assign_match(m[I + 1], std::get<I>(r)), ...);
+        }(std::make_index_sequence<std::tuple_size_v<decltype(r)>>{});
+    }
+    add_record(sum, r);
+}
+
+struct stopwatch {
+    std::chrono::steady_clock::time_point t0;
+    double                                seconds = 0;
+    void start() { t0 = std::chrono::steady_clock::now(); }
+    void stop()  { seconds += std::chrono::duration<double>(std::chrono::steady_clock::now() - t0).count(); }
+};
+
+struct measurement {
+    double              seconds = 0;
+    checksum            sum;
+    std::vector<double> latency_ns;  // Empty for engines that only scan whole inputs.
+};
+
+// Best of reps runs of run(sum, watch), run starts and stops the watch around the part that is measured.
+template <class Run>
+measurement best_of(int reps, Run&& run) {
+    measurement m;
+    m.seconds = std::numeric_limits<double>::infinity();
+    for (int k = 0; k < reps; ++k) {
+        checksum  sum;
+        stopwatch watch;
+        run(sum, watch);
+        m.seconds = std::min(m.seconds, watch.seconds);
+        m.sum     = sum;
+    }
+    return m;
+}
+
+template <class Line>
+measurement per_line(const input& in, int reps, Line&& line) {
+    auto m = best_of(reps, [&](checksum& sum, stopwatch& watch) {
+        watch.start();
+        for (std::size_t i = 0; i < in.lines.size(); ++i) { line(in, i, sum); }
+        watch.stop();
+    });
+    checksum sum;
+    m.latency_ns.reserve(in.lines.size());
+    for (std::size_t i = 0; i < in.lines.size(); ++i) {
+        const auto t0 = std::chrono::steady_clock::now();
+        line(in, i, sum);
+        m.latency_ns.push_back(std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - t0).count());
+    }
+    return m;
+}
+
+double percentile(std::vector<double>& v, double p) {
+    const auto k = static_cast<std::size_t>(p * static_cast<double>(v.size() - 1));
+    std::ranges::nth_element(v, v.begin() + static_cast<std::ptrdiff_t>(k));
+    return v[k];
+}
+
+void report(const char* workload, const char* source, const char* engine, const input& in, measurement m) {
+    const double mb  = static_cast<double>(in.text.size()) / 1e6 / m.seconds;
+    const double rec = static_cast<double>(in.lines.size()) / 1e6 / m.seconds;
+    std::printf("%-8s %-12s %-14s %9.1f %9.2f", workload, source, engine, mb, rec);
+    if (m.latency_ns.empty()) { std::printf(" %9s %9s %9s", "-", "-", "-"); }
+    else {
+        std::printf(" %9.0f %9.0f %9.0f", percentile(m.latency_ns, 0.5), percentile(m.latency_ns, 0.99),
+                    percentile(m.latency_ns, 0.999));
+    }
+    std::printf("  %.9g/%zu\n", m.sum.num, m.sum.chars);
+}
+
+template <class W>
+void run_workload(std::size_t records, int reps, const std::filesystem::path& file) {
+    const input in = make_input<W>(records);
+
+    report(W::name, "string_view", "format_from", in, per_line(in, reps, line_format_from<W>));
+    report(W::name, "string_view", "vscan",       in, per_line(in, reps, line_vscan<W>));
+    report(W::name, "string_view", "scan_lines",  in, best_of(reps, [&](checksum& sum, stopwatch& watch) {
+        watch.start();
+        const auto out = scan_lines_of<W, std::string_view>(std::string_view{ in.text });
+        watch.stop();
+        sum = columns_checksum(out);
+    }));
+    report(W::name, "string_view", "sscanf",      in, per_line(in, reps, line_sscanf<W>));
+    report(W::name, "string_view", "std::regex",  in, per_line(in, std::min(reps, 2), line_regex<W>));
+
+    auto stream_records = [&](std::istream& s, checksum& sum) {
+        typename W::template record<std::string> r{};
+        while (W::read(s, r)) { add_record(sum, r); }
+    };
+    report(W::name, "stringstream", "scan_lines", in, best_of(reps, [&](checksum& sum, stopwatch& watch) {
+        std::stringstream       ss{ in.text };
+        watch.start();
+        basic_scannable_istream rng{ ss };
+        const auto out = scan_lines_of<W, std::string>(rng);
+        watch.stop();
+        sum = columns_checksum(out);
+    }));
+    report(W::name, "stringstream", "istream >>", in, best_of(reps, [&](checksum& sum, stopwatch& watch) {
+        std::stringstream ss{ in.text };
+        watch.start();
+        stream_records(ss, sum);
+        watch.stop();
+    }));
+
+    { std::ofstream{ file, std::ios::binary } << in.text; }
+    report(W::name, "file", "scan_lines", in, best_of(reps, [&](checksum& sum, stopwatch& watch) {
+        watch.start();
+        auto map = mapped_file_range::open(file);
+        if (!map) { std::fprintf(stderr, "can't map %s\n", file.string().c_str()); return; }
+        const auto out = scan_lines_of<W, std::string_view>(map->view());
+        watch.stop();
+        sum = columns_checksum(out);
+    }));
+    report(W::name, "file", "fscanf", in, best_of(reps, [&](checksum& sum, stopwatch& watch) {
+        watch.start();
+        std::FILE* f = std::fopen(file.string().c_str(), "rb");
+        if (!f) { return; }
+        typename W::template record<c_text> r{};
+        while (std::apply([&](auto& ... v) { return std::fscanf(f, W::scanf_fmt, c_arg(v)...); }, r) == std::tuple_size_v<decltype(r)>) {
+            add_record(sum, r);
+        }
+        std::fclose(f);
+        watch.stop();
+    }));
+    report(W::name, "file", "istream >>", in, best_of(reps, [&](checksum& sum, stopwatch& watch) {
+        watch.start();
+        std::ifstream f{ file, std::ios::binary };
+        stream_records(f, sum);
+        watch.stop();
+    }));
+}
+
+} //! namespace
+
+int main(int argc, char* argv[]) {
+    const std::size_t records = argc > 1 ? std::stoull(argv[1]) : 200000;
+    const int         reps    = argc > 2 ? std::stoi(argv[2]) : 5;
+    const auto        file    = std::filesystem::temp_directory_path() / "nextgenscan_bench.txt";
+
+    std::printf("%zu records per workload, best of %d runs\n\n", records, reps);
+    std::printf("%-8s %-12s %-14s %9s %9s %9s %9s %9s  %s\n", "workload", "source", "engine", "MB/s", "Mrec/s",
+                "p50 ns", "p99 ns", "p99.9 ns", "checksum");
+
+    run_workload<int_workload>(records, reps, file);
+    run_workload<float_workload>(records, reps, file);
+    run_workload<string_workload>(records, reps, file);
+    run_workload<mixed_workload>(records, reps, file);
+
+    std::error_code ec;
+    std::filesystem::remove(file, ec);
+}
@@ -0,0 +1,2594 @@
+#pragma once
+
+// The scanning engine: format_from, std::p1729r3::scan / scan_from / vscan, scan_lines, scan_feeder, scan_each
+// and the ranges they read.
+#include <expected>
+#include <ranges>
+#include <format>
+#include <istream>
+#include <sstream>
+#include <vector>
+#include <cmath>
+#include <fstream>
+#include <numeric>
+#include <string>
+#include <string_view>
+#include <span>
+#include <limits>
+#include <algorithm>
+#include <charconv>
+#include <tuple>
+#include <memory>
+#include <memory_resource>
+#include <mutex>
+#include <optional>
+#include <thread>
+#include <filesystem>
+#include <system_error>
+#include <utility>
+#include <cstdint>
+#include <cstring>
+#include <bit>
+#include <iterator>
+
+// The pshufb kernels (integer blocks, [...] classes, UTF-8 validation) don't need an SSSE3 build: without one they
+// are compiled for SSSE3 on their own and taken only when cpuid reports it. SSE2 and AVX2 paths follow the target
+// of the build, build with -march=native (or -mavx2, /arch:AVX2) to get the 32 byte loops.
+#if defined(__SSSE3__)
+#    define _SCAN_SSSE3
+#    define _SCAN_SSSE3_TARGET
+#elif (defined(__GNUC__) || defined(__clang__)) && (defined(__x86_64__) || (defined(__i386__) && defined(__SSE2__)))
+#    define _SCAN_SSSE3
+#    define _SCAN_SSSE3_TARGET __attribute__((target("ssse3")))
+#elif defined(_MSC_VER) && (defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2))
+#    define _SCAN_SSSE3
+#    define _SCAN_SSSE3_TARGET
+#    include <intrin.h>
+#endif
+
+#if defined(__SSE2__) || defined(_SCAN_SSSE3) || defined(__AVX2__)
+#    include <immintrin.h>
+#endif
+
+#ifdef _WIN32
+#    ifndef NOMINMAX
+#        define NOMINMAX
+#    endif
+#    include <windows.h>
+#else
+#    include <cerrno>
+#    include <fcntl.h>
+#    include <sys/mman.h>
+#    include <sys/stat.h>
+#    include <unistd.h>
+#endif
+
+#include "std_scan_p1729r3.hpp"
+
+
+#define _SCAN_UNEXPECT(error, str) std::unexpected(std::p1729r3::scan_error{std::p1729r3::scan_error::error, str })
+
+#if defined(_SCAN_SSSE3)
+// Whether the SSSE3 kernels may run here, asked once per process.
+inline bool _Scn_has_ssse3() noexcept {
+#    if defined(__SSSE3__)
+    return true;
+#    elif defined(_MSC_VER) && !defined(__clang__)
+    static const bool has = [] { int regs[4]; __cpuid(regs, 1); return (regs[2] & (1 << 9)) != 0; }();
+    return has;
+#    else
+    static const bool has = [] { __builtin_cpu_init(); return __builtin_cpu_supports("ssse3") != 0; }();
+    return has;
+#    endif
+}
+#endif
+
+// Build with SCAN_STATS defined to count what every pattern costs, see scan_stats_snapshot().
+// Without it the hooks below expand to nothing.
+#ifdef SCAN_STATS
+#    include <atomic>
+#    include <chrono>
+#    include <deque>
+#    include <unordered_map>
+#    define _SCAN_STATS(...) __VA_ARGS__
+#else
+#    define _SCAN_STATS(...)
+#endif
+
+#ifdef SCAN_STATS
+inline constexpr std::size_t _Scn_type_count = static_cast<std::size_t>(std::p1729r3::_Scn_arg_type::_Custom) + 1;
+inline constexpr std::size_t _Scn_code_count = static_cast<std::size_t>(std::p1729r3::scan_error::value_out_of_range) + 1;
+
+// Written by one thread only, so bumping it is a plain load and store and other threads may still read it.
+class _Scn_counter {
+public:
+    void          add(std::uint64_t n) noexcept { v_.store(v_.load(std::memory_order_relaxed) + n, std::memory_order_relaxed); }
+    std::uint64_t get()          const noexcept { return v_.load(std::memory_order_relaxed); }
+private:
+    std::atomic<std::uint64_t> v_{ 0 };
+};
+
+// Counters of one pattern on one thread.
+struct _Scn_stats_slot {
+    std::string                                 pattern;
+    _Scn_counter                                calls;
+    _Scn_counter                                bytes;
+    _Scn_counter                                literal_mismatches;
+    _Scn_counter                                format_ns;
+    _Scn_counter                                convert_ns;
+    std::array<_Scn_counter, _Scn_type_count>   fields;
+    std::array<_Scn_counter, _Scn_code_count>   errors;
+
+    explicit _Scn_stats_slot(std::string_view p) : pattern(p) {}
+};
+
+struct _Scn_stats_registry {
+    std::mutex                   mutex;
+    std::deque<_Scn_stats_slot>  slots; // Never shrinks, threads keep pointers into it.
+
+    static _Scn_stats_registry& get() { static _Scn_stats_registry r; return r; }
+};
+
+// The registry lock is only taken the first time a thread runs a pattern.
+inline _Scn_stats_slot* _Scn_stats_slot_for(std::string_view pattern) {
+    thread_local std::unordered_map<std::string_view, _Scn_stats_slot*> cache;
+    if (auto it = cache.find(pattern); it != cache.end()) { return it->second; }
+
+    auto& reg = _Scn_stats_registry::get();
+    std::lock_guard lock{ reg.mutex };
+    auto* slot = &reg.slots.emplace_back(pattern);
+    cache.emplace(slot->pattern, slot);
+    return slot;
+}
+
+// The pattern currently executing on this thread, conversions are charged to it.
+struct _Scn_stats_frame {
+    _Scn_stats_slot*       slot       = nullptr;
+    std::chrono::nanoseconds convert  = {};
+};
+inline thread_local _Scn_stats_frame* _Scn_stats_current = nullptr;
+
+// Lives for one execution of a pattern. Time not spent converting values is charged to the format side:
+// literal matching, skipping spaces and, for runtime patterns, parsing the replacement fields.
+template <class Context>
+class _Scn_stats_scope {
+public:
+    // Patterns of wider code units are keyed by their bytes.
+    template <typename CharT>
+    _Scn_stats_scope(const Context& ctx, std::basic_string_view<CharT> pattern)
+        : ctx_(ctx), first_(ctx.current()), prev_(_Scn_stats_current), start_(std::chrono::steady_clock::now()) {
+        frame_.slot        = _Scn_stats_slot_for({ reinterpret_cast<const char*>(pattern.data()), pattern.size() * sizeof(CharT) });
+        _Scn_stats_current = &frame_;
+    }
+    _Scn_stats_scope(const _Scn_stats_scope&) = delete;
+    ~_Scn_stats_scope() {
+        auto total = std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - start_);
+        auto* slot = frame_.slot;
+        slot->calls.add(1);
+        slot->bytes.add(static_cast<std::uint64_t>(std::ranges::distance(first_, ctx_.current())));
+        slot->convert_ns.add(static_cast<std::uint64_t>(frame_.convert.count()));
+        slot->format_ns.add(static_cast<std::uint64_t>((total - frame_.convert).count()));
+        _Scn_stats_current = prev_;
+    }
+
+    void mismatch()                                noexcept { frame_.slot->literal_mismatches.add(1); }
+    void fail(const std::p1729r3::scan_error& e)   noexcept { frame_.slot->errors[static_cast<std::size_t>(e.code)].add(1); }
+private:
+    const Context&                                    ctx_;
+    typename Context::iterator                        first_;
+    _Scn_stats_frame                                  frame_;
+    _Scn_stats_frame*                                 prev_;
+    std::chrono::steady_clock::time_point             start_;
+};
+
+// Counts one field of the given type and charges its conversion to the running pattern.
+class _Scn_field_timer {
+public:
+    explicit _Scn_field_timer(std::p1729r3::_Scn_arg_type type) : frame_(_Scn_stats_current), start_(std::chrono::steady_clock::now()) {
+        if (frame_) { frame_->slot->fields[static_cast<std::size_t>(type)].add(1); }
+    }
+    _Scn_field_timer(const _Scn_field_timer&) = delete;
+    ~_Scn_field_timer() {
+        if (frame_) { frame_->convert += std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - start_); }
+    }
+private:
+    _Scn_stats_frame*                      frame_;
+    std::chrono::steady_clock::time_point  start_;
+};
+
+// Totals of one pattern over every thread that ran it.
+struct scan_stats {
+    std::string                                   pattern;
+    std::uint64_t                                 calls              = 0;
+    std::uint64_t                                 bytes              = 0; // Code units consumed.
+    std::uint64_t                                 literal_mismatches = 0;
+    std::array<std::uint64_t, _Scn_type_count>    fields             = {}; // Indexed by _Scn_arg_type.
+    std::array<std::uint64_t, _Scn_code_count>    errors             = {}; // Indexed by scan_error::code_type.
+    std::chrono::nanoseconds                      format_time        = {};
+    std::chrono::nanoseconds                      convert_time       = {};
+};
+
+// Safe to call while other threads are scanning, their counters are read as they are at that moment.
+inline std::vector<scan_stats> scan_stats_snapshot() {
+    auto& reg = _Scn_stats_registry::get();
+    std::lock_guard lock{ reg.mutex };
+
+    std::vector<scan_stats> out;
+    std::unordered_map<std::string_view, std::size_t> index;
+    for (const auto& slot : reg.slots) {
+        auto [it, fresh] = index.emplace(slot.pattern, out.size());
+        if (fresh) { out.emplace_back().pattern = slot.pattern; }
+        auto& s = out[it->second];
+
+        s.calls              += slot.calls.get();
+        s.bytes              += slot.bytes.get();
+        s.literal_mismatches += slot.literal_mismatches.get();
+        s.format_time        += std::chrono::nanoseconds(slot.format_ns.get());
+        s.convert_time       += std::chrono::nanoseconds(slot.convert_ns.get());
+        for (std::size_t k = 0; k < _Scn_type_count; ++k) { s.fields[k] += slot.fields[k].get(); }
+        for (std::size_t k = 0; k < _Scn_code_count; ++k) { s.errors[k] += slot.errors[k].get(); }
+    }
+    return out;
+}
+#endif
+
+// How the fields of one pattern name their arguments, a pattern uses either explicit ids or none at all.
+enum class _Scn_indexing : std::uint8_t { _Unknown, _Manual, _Automatic };
+
+// Argument ids handed out so far. They are counted here rather than by the parse context, whose checks fail the
+// build in constant evaluation instead of returning an error.
+struct _Scn_arg_ids {
+    _Scn_indexing mode = _Scn_indexing::_Unknown;
+    std::size_t   next = 0;  // The next automatic id.
+};
+
+template <typename CharT>
+constexpr std::expected<std::tuple<typename std::p1729r3::basic_scan_parse_context<CharT>::iterator, std::size_t>,
+    std::p1729r3::scan_error> _Get_scan_replacement(std::p1729r3::basic_scan_parse_context<CharT>& ptx, _Scn_arg_ids& ids) {
+
+    auto i = std::next(ptx.begin());
+    std::optional<std::size_t> id;
+
+    for (; i != ptx.end() && *i != ':' && *i != '}'; ++i) {
+        if (*i < '0' || *i > '9') { return _SCAN_UNEXPECT(invalid_format_string, "Invalid character in replacment field"); }
+        const auto d = static_cast<std::size_t>(*i - '0');
+        if (id && *id > (std::numeric_limits<std::size_t>::max() - d) / 10) {
+            return _SCAN_UNEXPECT(invalid_format_string, "Argument id is too large!");
+        }
+        id = id.value_or(0) * 10 + d;
+    }
+    if (i == ptx.end())                              return _SCAN_UNEXPECT(invalid_format_string, "Unterminated replacement field!");
+    if (*i == ':' && std::next(i) != ptx.end() && *std::next(i) == '}') return _SCAN_UNEXPECT(invalid_format_string, "Scan description is empty!");
+
+    // An id past the arguments is left to the caller: lowering rejects it, _Vscan fails when its field is scanned.
+    if (id) {
+        if (ids.mode == _Scn_indexing::_Automatic) { return _SCAN_UNEXPECT(invalid_format_string, "Cannot switch from automatic to manual argument indexing!"); }
+        ids.mode = _Scn_indexing::_Manual;
+    }
+    else {
+        if (ids.mode == _Scn_indexing::_Manual) { return _SCAN_UNEXPECT(invalid_format_string, "Cannot switch from manual to automatic argument indexing!"); }
+        ids.mode = _Scn_indexing::_Automatic;
+        id = ids.next++;
+    }
+    return std::make_tuple(i, *id);
+
+}
+
+
+enum class _Scn_align : uint8_t { _None, _Left, _Right, _Center };
+enum class _Scn_sign : uint8_t { _None, _Plus, _Minus, _Space };
+
+// Membership table of a [...] character class, built while the pattern is parsed. The 256 bits are laid out for
+// nibble lookups: bit (c >> 4) & 7 of table[(c >> 7) * 16 + (c & 15)], so shuffles can classify 16 or 32 bytes at once.
+// Code units past 0xFF are members only of negated classes.
+struct _Scn_charset {
+    std::uint8_t table[32] = {};
+    bool         negated   = false;
+
+    constexpr void insert(unsigned c) { table[(c >> 7) * 16 + (c & 15)] |= static_cast<std::uint8_t>(1u << ((c >> 4) & 7)); }
+    constexpr bool test(unsigned c) const {
+        if (c > 0xFF) { return negated; }
+        return (table[(c >> 7) * 16 + (c & 15)] >> ((c >> 4) & 7)) & 1;
+    }
+    constexpr void flip() {
+        for (auto& t : table) { t = static_cast<std::uint8_t>(~t); }
+        negated = !negated;
+    }
+};
+
+template <class CharT>
+struct _Basic_scn_specs {
+    int        width = 0;
+    int        precision = -1;
+    char       type = '\0';
+    _Scn_align alignment = _Scn_align::_None;
+    _Scn_sign  sgn = _Scn_sign::_None;
+    bool       alt = false;
+    bool       localized = false;
+    bool       leading_zero = false;
+    uint8_t    fill_length = 1;
+    // At most one codepoint (so one char32_t or four utf-8 char8_t).
+    CharT      fill[4 / sizeof(CharT)] = { CharT{' '} };
+    // Filled when type is '['.
+    _Scn_charset charset;
+};
+
+// Parses the class starting at '[' like scanf: '^' negates, a leading ']' is a member and '-' between two
+// members is a range. Returns the position of the closing ']'.
+template <typename It>
+constexpr std::expected<It, std::p1729r3::scan_error> _Parse_charset(It i, It end, _Scn_charset& set) {
+    using unsigned_type = std::make_unsigned_t<std::iter_value_t<It>>;
+
+    bool neg = false;
+    if (++i != end && *i == '^') { neg = true; ++i; }
+    for (bool first = true; i != end && (*i != ']' || first); ++i, first = false) {
+        const unsigned lo = static_cast<unsigned_type>(*i);
+        unsigned       hi = lo;
+        if (std::next(i) != end && *std::next(i) == '-' && std::next(i, 2) != end && *std::next(i, 2) != ']') {
+            std::advance(i, 2);
+            hi = static_cast<unsigned_type>(*i);
+        }
+        if (hi > 0xFF) { return _SCAN_UNEXPECT(invalid_format_string, "Character class member is out of range!"); }
+        if (hi < lo)   { return _SCAN_UNEXPECT(invalid_format_string, "Character class range is reversed!"); }
+        for (unsigned c = lo; c <= hi; ++c) { set.insert(c); }
+    }
+    if (i == end) { return _SCAN_UNEXPECT(invalid_format_string, "Unterminated character class!"); }
+    if (neg) { set.flip(); }
+    return i;
+}
+
+constexpr _Scn_align _Scn_align_of(unsigned c) {
+    switch (c) {
+    case '<': return _Scn_align::_Left;
+    case '>': return _Scn_align::_Right;
+    case '^': return _Scn_align::_Center;
+    default:  return _Scn_align::_None;
+    }
+}
+
+// Code units of the code point that starts with c, malformed sequences count as one unit.
+template <typename CharT>
+constexpr std::size_t _Scn_code_units(CharT c) {
+    const auto u = static_cast<std::make_unsigned_t<CharT>>(c);
+    if constexpr (sizeof(CharT) == 1) { return u < 0xC0 ? 1 : u < 0xE0 ? 2 : u < 0xF0 ? 3 : u < 0xF8 ? 4 : 1; }
+    else if constexpr (sizeof(CharT) == 2) { return u >= 0xD800 && u < 0xDC00 ? 2 : 1; }
+    else { return 1; }
+}
+
+// std-format-spec of P1729: [[fill]align][width][L][type]. The fill is one code point other than '{', '}' and '[',
+// width is the most code units the field (fill included) may take, type is one of the floating point letters,
+// d x X o b B, or a [...] character class.
+template <typename CharT>
+constexpr std::p1729r3::basic_parser_result_type<CharT> _Parse_basic(const std::p1729r3::basic_scan_parse_context<CharT>& pctx, 
+                                                                    _Basic_scn_specs<CharT>& specs) {
+    auto       i   = pctx.begin();
+    const auto end = pctx.end();
+    if (i != end && *i == ':') { ++i; }
+
+    if (i != end && *i != '}') {
+        const auto n = static_cast<std::ptrdiff_t>(_Scn_code_units(*i));
+        // '[' always opens a class, otherwise "[^...]" would read as fill '[' centered.
+        if (*i != '[' && std::distance(i, end) > n && _Scn_align_of(static_cast<unsigned>(*std::next(i, n))) != _Scn_align::_None) {
+            if (*i == '{' || *i == '}') { return _SCAN_UNEXPECT(invalid_format_string, "Invalid fill character!"); }
+            std::copy(i, std::next(i, n), specs.fill);
+            specs.fill_length = static_cast<std::uint8_t>(n);
+            specs.alignment   = _Scn_align_of(static_cast<unsigned>(*std::next(i, n)));
+            std::advance(i, n + 1);
+        }
+        else if (_Scn_align_of(static_cast<unsigned>(*i)) != _Scn_align::_None) {
+            specs.alignment = _Scn_align_of(static_cast<unsigned>(*i));
+            ++i;
+        }
+    }
+    if (i != end && *i >= '0' && *i <= '9') {
+        if (*i == '0') { return _SCAN_UNEXPECT(invalid_format_string, "Field width must be positive!"); }
+        for (; i != end && *i >= '0' && *i <= '9'; ++i) {
+            if (specs.width > (std::numeric_limits<int>::max() - 9) / 10) { return _SCAN_UNEXPECT(invalid_format_string, "Field width is too large!"); }
+            specs.width = specs.width * 10 + static_cast<int>(*i - '0');
+        }
+    }
+    if (i != end && *i == 'L') { specs.localized = true; ++i; }
+    if (i != end) {
+        switch (*i) {
+        case 'a': case 'A': case 'e': case 'E': case 'f': case 'F': case 'g': case 'G':
+        case 'd': case 'x': case 'X': case 'o': case 'b': case 'B':
+            specs.type = static_cast<char>(*i);
+            ++i;
+            break;
+        case '[': {
+            auto res = _Parse_charset(i, end, specs.charset);
+            if (!res.has_value()) { return std::unexpected(res.error()); }
+            i          = std::next(res.value());
+            specs.type = '[';
+            break;
+        }
+        default:
+            break;
+        }
+    }
+    if (i == end)  { return _SCAN_UNEXPECT(invalid_format_string, "Unterminated replacement field!"); }
+    if (*i != '}') { return _SCAN_UNEXPECT(invalid_format_string, "Invalid format specifier!"); }
+    // Return the next element of }
+    return std::next(i);
+}
+
+// Ranges whose characters sit in one block of memory, converters run on the source there instead of copying it out.
+template <class Rng, typename CharT>
+concept _Scn_contiguous = std::ranges::contiguous_range<Rng> && std::ranges::sized_range<Rng> &&
+                          std::same_as<std::ranges::range_value_t<Rng>, CharT>;
+
+// Code unit types the engine scans natively. Ranges of anything else are read as char.
+template <typename Ty>
+concept _Scn_code_unit = std::same_as<Ty, char>     || std::same_as<Ty, wchar_t> || std::same_as<Ty, char8_t> ||
+                         std::same_as<Ty, char16_t> || std::same_as<Ty, char32_t>;
+
+template <class Rng>
+using _Scn_char_t = std::conditional_t<_Scn_code_unit<std::ranges::range_value_t<Rng>>, std::ranges::range_value_t<Rng>, char>;
+
+// Contiguous byte sized code units: the char kernels run on UTF-8 text through a char pointer.
+template <class Rng>
+concept _Scn_bytes = std::ranges::contiguous_range<Rng> && std::ranges::sized_range<Rng> &&
+                     (std::same_as<std::ranges::range_value_t<Rng>, char> || std::same_as<std::ranges::range_value_t<Rng>, char8_t>);
+
+template <_Scn_bytes Rng>
+const char* _Scn_bytes_of(const Rng& rng) { return reinterpret_cast<const char*>(std::ranges::data(rng)); }
+
+// What is left of a context handed back to the caller, ranges that don't outlive the call come back as dangling.
+template <class Rng, class Sub>
+constexpr std::ranges::borrowed_subrange_t<Rng> _Scn_borrow(Sub rest) {
+    if constexpr (std::ranges::borrowed_range<Rng>) { return { rest.begin(), rest.end() }; }
+    else                                            { return std::ranges::dangling{}; }
+}
+
+// Base of an integer presentation type, the default is decimal.
+constexpr unsigned _Scn_base(char type) {
+    switch (type) {
+    case 'x': case 'X': return 16;
+    case 'o':           return 8;
+    case 'b': case 'B': return 2;
+    default:            return 10;
+    }
+}
+
+// Value of c as a digit in bases up to 36, 36 when it is no digit at all.
+constexpr unsigned _Scn_digit(unsigned c) {
+    if (c - '0' < 10)                   { return c - '0'; }
+    if ((c | 0x20) - 'a' < 26)          { return (c | 0x20) - 'a' + 10; }
+    return 36;
+}
+
+// Whether [i, last) starts with the 0x / 0b prefix of base followed by a digit, a lone "0x" is the number 0.
+template <typename It, typename Se>
+constexpr bool _Scn_has_prefix(It i, Se last, unsigned base) {
+    if (base != 16 && base != 2) { return false; }
+    if (i == last || *i != '0') { return false; }
+    if (++i == last || (static_cast<unsigned>(*i) | 0x20) != (base == 16 ? 'x' : 'b')) { return false; }
+    return ++i != last && _Scn_digit(static_cast<unsigned>(*i)) < base;
+}
+
+// Conversion for ranges from_chars can't run on, same acceptance and errors as from_chars plus a leading '+' and
+// the base prefix, like scanf.
+template <std::integral Ty, typename It, typename Se>
+constexpr std::expected<It, std::p1729r3::scan_error> _Parse_integer(It first, Se last, Ty& value, unsigned base = 10) {
+    using unsigned_type = std::make_unsigned_t<Ty>;
+
+    auto i   = first;
+    bool neg = false;
+    if (i != last && (*i == '+' || (std::is_signed_v<Ty> && *i == '-'))) { neg = *i == '-'; ++i; }
+    if (_Scn_has_prefix(i, last, base)) { std::advance(i, 2); }
+    const unsigned_type limit = static_cast<unsigned_type>(std::numeric_limits<Ty>::max()) + (neg ? 1 : 0);
+
+    unsigned_type v        = 0;
+    bool          overflow = false;
+    auto          digits   = i;
+    for (; i != last; ++i) {
+        const unsigned d = _Scn_digit(static_cast<unsigned>(*i));
+        if (d >= base)                   { break; }
+        if (v > (limit - d) / base)      { overflow = true; }
+        else                             { v = v * base + d; }
+    }
+    if (i == digits) { return _SCAN_UNEXPECT(invalid_scanned_value, "No digits for an integer!"); }
+    if (overflow)    { return _SCAN_UNEXPECT(value_out_of_range, "Integer is out of range!"); }
+    value = neg ? static_cast<Ty>(unsigned_type{ 0 } - v) : static_cast<Ty>(v);
+    return i;
+}
+
+// SWAR helpers, eight characters in one 64-bit word with the first character in the lowest byte.
+inline constexpr std::uint64_t _Swar_ones = 0x0101010101010101ull;
+inline constexpr std::uint64_t _Swar_high = 0x8080808080808080ull;
+
+inline std::uint64_t _Swar_load(const char* p) {
+    std::uint64_t x;
+    std::memcpy(&x, p, sizeof(x));
+    if constexpr (std::endian::native == std::endian::big) { x = std::byteswap(x); }
+    return x;
+}
+
+// 0x80 in every byte that lies in [lo, hi], computed on the low seven bits so no borrow crosses a byte.
+constexpr std::uint64_t _Swar_in_range(std::uint64_t x, unsigned lo, unsigned hi) {
+    const std::uint64_t y = x & ~_Swar_high;
+    return (y + _Swar_ones * (0x80 - lo)) & ~(y + _Swar_ones * (0x7F - hi)) & ~x & _Swar_high;
+}
+
+// 0x80 in every byte that is a digit of Base.
+template <unsigned Base>
+constexpr std::uint64_t _Swar_digits(std::uint64_t x) {
+    if constexpr (Base <= 10) { return _Swar_in_range(x, '0', '0' + Base - 1); }
+    else { return _Swar_in_range(x, '0', '9') | _Swar_in_range(x, 'a', 'a' + Base - 11) | _Swar_in_range(x, 'A', 'A' + Base - 11); }
+}
+
+// Value of eight digits of Base, the products of every step stay inside their lanes.
+template <unsigned Base>
+constexpr std::uint64_t _Swar_value(std::uint64_t x) {
+    if constexpr (Base <= 10) { x &= 0x0F0F0F0F0F0F0F0Full; }
+    else                      { x = (x & 0x0F0F0F0F0F0F0F0Full) + ((x >> 6) & _Swar_ones) * 9; }
+    x = (x & 0x00FF00FF00FF00FFull) * Base                       + ((x >> 8)  & 0x00FF00FF00FF00FFull);
+    x = (x & 0x0000FFFF0000FFFFull) * (Base * Base)               + ((x >> 16) & 0x0000FFFF0000FFFFull);
+    x = (x & 0x00000000FFFFFFFFull) * (Base * Base * Base * Base) + (x >> 32);
+    return x;
+}
+
+// Length of the run of Base digits at the front of [p, last).
+template <unsigned Base>
+std::size_t _Digit_run(const char* p, const char* last) {
+    const char* i = p;
+#if defined(__SSE2__)
+    if constexpr (Base == 10) {
+        for (; last - i >= 16; i += 16) {
+            const __m128i d   = _mm_sub_epi8(_mm_loadu_si128(reinterpret_cast<const __m128i*>(i)), _mm_set1_epi8('0'));
+            const auto    out = static_cast<std::uint32_t>(~_mm_movemask_epi8(_mm_cmpeq_epi8(_mm_min_epu8(d, _mm_set1_epi8(9)), d)) & 0xFFFF);
+            if (out) { return static_cast<std::size_t>(i - p) + std::countr_zero(out); }
+        }
+    }
+#endif
+    for (; last - i >= 8; i += 8) {
+        const std::uint64_t out = ~_Swar_digits<Base>(_Swar_load(i)) & _Swar_high;
+        if (out) { return static_cast<std::size_t>(i - p) + std::countr_zero(out) / 8; }
+    }
+    for (; i != last && _Scn_digit(static_cast<unsigned char>(*i)) < Base; ++i) {}
+    return static_cast<std::size_t>(i - p);
+}
+
+#if defined(_SCAN_SSSE3)
+// Value of the 16 decimal digits at p. Pairs, quads and octets of digits are combined by multiply-adds, the two
+// octets are joined at the end.
+_SCAN_SSSE3_TARGET inline std::uint64_t _Digits16_value(const char* p) {
+    const __m128i d  = _mm_sub_epi8(_mm_loadu_si128(reinterpret_cast<const __m128i*>(p)), _mm_set1_epi8('0'));
+    const __m128i d2 = _mm_maddubs_epi16(d, _mm_setr_epi8(10, 1, 10, 1, 10, 1, 10, 1, 10, 1, 10, 1, 10, 1, 10, 1));
+    const __m128i d4 = _mm_madd_epi16(d2, _mm_setr_epi16(100, 1, 100, 1, 100, 1, 100, 1));
+    const __m128i d8 = _mm_madd_epi16(_mm_packs_epi32(d4, d4), _mm_setr_epi16(10000, 1, 10000, 1, 10000, 1, 10000, 1));
+    return static_cast<std::uint64_t>(static_cast<std::uint32_t>(_mm_cvtsi128_si32(d8))) * 100000000u +
+           static_cast<std::uint32_t>(_mm_cvtsi128_si32(_mm_srli_si128(d8, 4)));
+}
+#endif
+
+// Value of n digits of Base, n small enough that it can't overflow 64 bits.
+template <unsigned Base>
+std::uint64_t _Digits_value(const char* p, std::size_t n) {
+    constexpr std::uint64_t base8 = std::uint64_t{ Base * Base * Base * Base } * (Base * Base * Base * Base);
+    std::uint64_t v = 0;
+#if defined(_SCAN_SSSE3)
+    if constexpr (Base == 10) {
+        if (n >= 16 && _Scn_has_ssse3()) {
+            v  = _Digits16_value(p);
+            p += 16;
+            n -= 16;
+        }
+    }
+#endif
+    for (; n >= 8; p += 8, n -= 8) { v = v * base8 + _Swar_value<Base>(_Swar_load(p)); }
+    for (; n != 0; ++p, --n)       { v = v * Base + _Scn_digit(static_cast<unsigned char>(*p)); }
+    return v;
+}
+
+// Unsigned conversion at the front of [p, last). The digit run is found a word or a vector at a time and then
+// converted in blocks; leading zeros are skipped and only the very last digit of a maximal length number needs an
+// overflow check. Returns the end of the digits, p when there are none.
+template <unsigned Base>
+const char* _Parse_digits(const char* p, const char* last, std::uint64_t& value, bool& overflow) {
+    constexpr std::size_t max_digits = Base == 10 ? 20 : Base == 16 ? 16 : Base == 8 ? 22 : 64;
+
+    const std::size_t n   = _Digit_run<Base>(p, last);
+    const char*       end = p + n;
+    if (n == 0) { return p; }
+
+    const char* q = p;
+    while (q != end - 1 && *q == '0') { ++q; }
+    const auto m = static_cast<std::size_t>(end - q);
+    if (m > max_digits) { overflow = true; return end; }
+
+    std::uint64_t v = _Digits_value<Base>(q, m - 1);
+    const unsigned d = _Scn_digit(static_cast<unsigned char>(end[-1]));
+    if (v > (std::numeric_limits<std::uint64_t>::max() - d) / Base) { overflow = true; return end; }
+    value = v * Base + d;
+    return end;
+}
+
+// In place conversion of contiguous characters with the kernels above, same acceptance and errors as from_chars
+// plus a leading '+' and the base prefix.
+template <std::integral Ty>
+std::expected<const char*, std::p1729r3::scan_error> _Parse_integer(const char* first, const char* last, Ty& value, unsigned base = 10) {
+    using unsigned_type = std::make_unsigned_t<Ty>;
+
+    const char* i   = first;
+    bool        neg = false;
+    if (i != last && (*i == '+' || (std::is_signed_v<Ty> && *i == '-'))) { neg = *i == '-'; ++i; }
+    if (_Scn_has_prefix(i, last, base)) { i += 2; }
+    const std::uint64_t limit = static_cast<unsigned_type>(std::numeric_limits<Ty>::max()) + std::uint64_t{ neg };
+
+    std::uint64_t v        = 0;
+    bool          overflow = false;
+    const char*   p        = i;
+    switch (base) {
+    case 16: p = _Parse_digits<16>(i, last, v, overflow); break;
+    case 8:  p = _Parse_digits<8>(i, last, v, overflow);  break;
+    case 2:  p = _Parse_digits<2>(i, last, v, overflow);  break;
+    default: p = _Parse_digits<10>(i, last, v, overflow); break;
+    }
+    if (p == i)                { return _SCAN_UNEXPECT(invalid_scanned_value, "No digits for an integer!"); }
+    if (overflow || v > limit) { return _SCAN_UNEXPECT(value_out_of_range, "Integer is out of range!"); }
+    value = neg ? static_cast<Ty>(unsigned_type{ 0 } - static_cast<unsigned_type>(v)) : static_cast<Ty>(v);
+    return p;
+}
+
+// Characters a floating point token may contain, from_chars decides how many of them actually belong to it.
+constexpr bool _Is_float_char(unsigned c) {
+    return (c >= '0' && c <= '9') || (c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z') ||
+           c == '.' || c == '+' || c == '-' || c == '(' || c == ')' || c == '_';
+}
+
+// Parses fixed, scientific, hex (with or without 0x) and inf/nan according to the presentation type.
+// from_chars does the conversion, it is exact and runs Eisel-Lemire with a big number fallback in current
+// standard libraries.
+template <std::floating_point Ty>
+std::expected<const char*, std::p1729r3::scan_error> _Parse_float(const char* first, const char* last, Ty& value, char type) {
+    const char* i   = first;
+    bool        neg = false;
+    if (i != last && (*i == '+' || *i == '-')) { neg = *i == '-'; ++i; }
+    if (i != last && (*i == '+' || *i == '-')) { return _SCAN_UNEXPECT(invalid_scanned_value, "Invalid floating point value!"); }
+
+    auto fmt = std::chars_format::general;
+    switch (type) {
+    case 'a': case 'A': fmt = std::chars_format::hex;        break;
+    case 'e': case 'E': fmt = std::chars_format::scientific; break;
+    case 'f': case 'F': fmt = std::chars_format::fixed;      break;
+    default:                                                 break;
+    }
+    const bool prefixed = (type == '\0' || fmt == std::chars_format::hex) && last - i > 2 &&
+                          i[0] == '0' && (i[1] == 'x' || i[1] == 'X');
+
+    auto res = std::from_chars(prefixed ? i + 2 : i, last, value, prefixed ? std::chars_format::hex : fmt);
+    // A bare "0x" is the number 0 followed by an 'x', just like strtod.
+    if (prefixed && type == '\0' && res.ec == std::errc::invalid_argument) { res = std::from_chars(i, last, value, fmt); }
+
+    if (res.ec == std::errc::invalid_argument)    { return _SCAN_UNEXPECT(invalid_scanned_value, "Invalid floating point value!"); }
+    if (res.ec == std::errc::result_out_of_range) { return _SCAN_UNEXPECT(value_out_of_range, "Floating point value is out of range!"); }
+    if (neg) { value = -value; }
+    return res.ptr;
+}
+
+constexpr bool _Is_space(unsigned c) {
+    return c == ' ' || c == '\t' || c == '\n' || c == '\r' || c == '\v' || c == '\f';
+}
+
+template <typename CharT>
+constexpr bool _Is_space_unit(CharT c) { return _Is_space(static_cast<std::make_unsigned_t<CharT>>(c)); }
+
+// Length of the leading run of [first, last) that is whitespace (Space) or that isn't (!Space). A byte is
+// whitespace when it equals ' ' or lies in '\t'..'\r', which is one compare and one unsigned range test per vector.
+template <bool Space>
+std::size_t _Span_spaces(const char* first, const char* last) {
+    const char* p = first;
+#if defined(__AVX2__)
+    {
+        const __m256i blank = _mm256_set1_epi8(' ');
+        const __m256i tab   = _mm256_set1_epi8('\t');
+        const __m256i four  = _mm256_set1_epi8(4);
+        for (; last - p >= 32; p += 32) {
+            const __m256i v  = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(p));
+            const __m256i d  = _mm256_sub_epi8(v, tab);
+            const __m256i ws = _mm256_or_si256(_mm256_cmpeq_epi8(v, blank), _mm256_cmpeq_epi8(_mm256_min_epu8(d, four), d));
+            const auto    m  = static_cast<std::uint32_t>(_mm256_movemask_epi8(ws));
+            const auto    out = Space ? ~m : m;
+            if (out) { return static_cast<std::size_t>(p - first) + std::countr_zero(out); }
+        }
+    }
+#endif
+#if defined(__SSE2__)
+    {
+        const __m128i blank = _mm_set1_epi8(' ');
+        const __m128i tab   = _mm_set1_epi8('\t');
+        const __m128i four  = _mm_set1_epi8(4);
+        for (; last - p >= 16; p += 16) {
+            const __m128i v  = _mm_loadu_si128(reinterpret_cast<const __m128i*>(p));
+            const __m128i d  = _mm_sub_epi8(v, tab);
+            const __m128i ws = _mm_or_si128(_mm_cmpeq_epi8(v, blank), _mm_cmpeq_epi8(_mm_min_epu8(d, four), d));
+            const auto    m  = static_cast<std::uint32_t>(_mm_movemask_epi8(ws));
+            const auto    out = (Space ? ~m : m) & 0xFFFFu;
+            if (out) { return static_cast<std::size_t>(p - first) + std::countr_zero(out); }
+        }
+    }
+#endif
+    for (; p != last && _Is_space(static_cast<unsigned char>(*p)) == Space; ++p) {}
+    return static_cast<std::size_t>(p - first);
+}
+
+template <typename It, typename Se>
+concept _Scn_byte_iter = std::contiguous_iterator<It> && std::sized_sentinel_for<Se, It> &&
+                         (std::same_as<std::iter_value_t<It>, char> || std::same_as<std::iter_value_t<It>, char8_t>);
+
+// Past the whitespace run starting at i, a vector at a time on contiguous bytes.
+template <typename It, typename Se>
+It _Skip_space_run(It i, Se last) {
+    if constexpr (_Scn_byte_iter<It, Se>) {
+        const char* p = reinterpret_cast<const char*>(std::to_address(i));
+        return i + static_cast<std::iter_difference_t<It>>(_Span_spaces<true>(p, p + (last - i)));
+    }
+    else {
+        while (i != last && _Is_space_unit(*i)) { ++i; }
+        return i;
+    }
+}
+
+// Length of the common prefix of two byte runs of length n, a full match of a long run costs one memcmp.
+inline std::size_t _Common_prefix(const char* a, const char* b, std::size_t n) {
+    std::size_t i = 0;
+    if (n < 16) {
+        while (i != n && a[i] == b[i]) { ++i; }
+        return i;
+    }
+    if (std::memcmp(a, b, n) == 0) { return n; }
+#if defined(__SSE2__)
+    for (; n - i >= 16; i += 16) {
+        const auto eq = static_cast<std::uint32_t>(_mm_movemask_epi8(_mm_cmpeq_epi8(
+                            _mm_loadu_si128(reinterpret_cast<const __m128i*>(a + i)),
+                            _mm_loadu_si128(reinterpret_cast<const __m128i*>(b + i)))));
+        if (eq != 0xFFFFu) { return i + std::countr_one(eq); }
+    }
+#endif
+    while (a[i] == b[i]) { ++i; }
+    return i;
+}
+
+// Matches n pattern units that hold no whitespace, whitespace in the input in front of any of them is skipped.
+// sc is left past the match or where the input differs.
+template <typename It, typename Se, typename CharT>
+bool _Match_segment(It& sc, Se last, const CharT* p, std::size_t n) {
+    if constexpr (_Scn_byte_iter<It, Se> && sizeof(CharT) == 1) {
+        const char* q = reinterpret_cast<const char*>(p);
+        for (;;) {
+            const char*       s = reinterpret_cast<const char*>(std::to_address(sc));
+            const std::size_t k = _Common_prefix(s, q, std::min<std::size_t>(n, static_cast<std::size_t>(last - sc)));
+            sc += static_cast<std::iter_difference_t<It>>(k);
+            q  += k;
+            n  -= k;
+            if (n == 0)                                   { return true; }
+            if (sc == last || !_Is_space_unit(*sc))       { return false; }
+            sc = _Skip_space_run(sc, last);
+        }
+    }
+    else {
+        for (; n != 0; ++p, --n) {
+            if (sc != last && _Is_space_unit(*sc))        { sc = _Skip_space_run(sc, last); }
+            if (sc == last || static_cast<CharT>(*sc) != *p) { return false; }
+            ++sc;
+        }
+        return true;
+    }
+}
+
+#if defined(_SCAN_SSSE3)
+// _Span_charset over whole blocks of 16 bytes, the bit of each byte is picked from its row of the table by two
+// pshufb lookups. Stops at the first byte outside of set or where less than a block is left.
+_SCAN_SSSE3_TARGET inline std::size_t _Span_charset_ssse3(const _Scn_charset& set, const char* first, const char* last) {
+    const char*   p      = first;
+    const __m128i t0     = _mm_loadu_si128(reinterpret_cast<const __m128i*>(set.table));
+    const __m128i t1     = _mm_loadu_si128(reinterpret_cast<const __m128i*>(set.table + 16));
+    const __m128i bitsel = _mm_setr_epi8(1, 2, 4, 8, 16, 32, 64, -128, 1, 2, 4, 8, 16, 32, 64, -128);
+    const __m128i lo4    = _mm_set1_epi8(0x0F);
+    const __m128i hi1    = _mm_set1_epi8(-128);
+    for (; last - p >= 16; p += 16) {
+        const __m128i v   = _mm_loadu_si128(reinterpret_cast<const __m128i*>(p));
+        const __m128i lo  = _mm_and_si128(v, lo4);
+        const __m128i row = _mm_or_si128(_mm_shuffle_epi8(t0, _mm_or_si128(lo, _mm_and_si128(v, hi1))),
+                                         _mm_shuffle_epi8(t1, _mm_or_si128(lo, _mm_andnot_si128(v, hi1))));
+        const __m128i bit = _mm_shuffle_epi8(bitsel, _mm_and_si128(_mm_srli_epi16(v, 4), _mm_set1_epi8(7)));
+        const auto    out = static_cast<std::uint32_t>(_mm_movemask_epi8(
+                                _mm_cmpeq_epi8(_mm_and_si128(row, bit), _mm_setzero_si128())));
+        if (out) { return static_cast<std::size_t>(p - first) + std::countr_zero(out); }
+    }
+    return static_cast<std::size_t>(p - first);
+}
+#endif
+
+// Length of the leading run of [first, last) that belongs to set, classifying a whole vector per step.
+inline std::size_t _Span_charset(const _Scn_charset& set, const char* first, const char* last) {
+    const char* p = first;
+#if defined(__AVX2__)
+    {
+        const __m256i t0     = _mm256_broadcastsi128_si256(_mm_loadu_si128(reinterpret_cast<const __m128i*>(set.table)));
+        const __m256i t1     = _mm256_broadcastsi128_si256(_mm_loadu_si128(reinterpret_cast<const __m128i*>(set.table + 16)));
+        const __m256i bitsel = _mm256_setr_epi8(1, 2, 4, 8, 16, 32, 64, -128, 1, 2, 4, 8, 16, 32, 64, -128,
+                                                1, 2, 4, 8, 16, 32, 64, -128, 1, 2, 4, 8, 16, 32, 64, -128);
+        const __m256i lo4    = _mm256_set1_epi8(0x0F);
+        const __m256i hi1    = _mm256_set1_epi8(-128);
+        for (; last - p >= 32; p += 32) {
+            const __m256i v   = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(p));
+            const __m256i lo  = _mm256_and_si256(v, lo4);
+            // An index with its top bit set selects zero, so each table only answers for its half of the bytes.
+            const __m256i row = _mm256_or_si256(_mm256_shuffle_epi8(t0, _mm256_or_si256(lo, _mm256_and_si256(v, hi1))),
+                                                _mm256_shuffle_epi8(t1, _mm256_or_si256(lo, _mm256_andnot_si256(v, hi1))));
+            const __m256i bit = _mm256_shuffle_epi8(bitsel, _mm256_and_si256(_mm256_srli_epi16(v, 4), _mm256_set1_epi8(7)));
+            const auto    out = static_cast<std::uint32_t>(_mm256_movemask_epi8(
+                                    _mm256_cmpeq_epi8(_mm256_and_si256(row, bit), _mm256_setzero_si256())));
+            if (out) { return static_cast<std::size_t>(p - first) + std::countr_zero(out); }
+        }
+    }
+#endif
+#if defined(_SCAN_SSSE3)
+    if (last - p >= 16 && _Scn_has_ssse3()) { p += _Span_charset_ssse3(set, p, last); }
+#endif
+    for (; p != last && set.test(static_cast<unsigned char>(*p)); ++p) {}
+    return static_cast<std::size_t>(p - first);
+}
+
+// Well formed UTF-8: no stray or missing continuation bytes, no overlong forms, surrogates or code points past U+10FFFF.
+template <typename It, typename Se>
+constexpr bool _Valid_utf8_units(It i, Se last) {
+    while (i != last) {
+        const unsigned c = static_cast<unsigned char>(*i++);
+        if (c < 0x80) { continue; }
+
+        unsigned lo = 0x80, hi = 0xBF, n = 0;
+        if      (c >= 0xC2 && c <= 0xDF) { n = 1; }
+        else if (c == 0xE0)              { n = 2; lo = 0xA0; }
+        else if (c == 0xED)              { n = 2; hi = 0x9F; }
+        else if (c >= 0xE1 && c <= 0xEF) { n = 2; }
+        else if (c == 0xF0)              { n = 3; lo = 0x90; }
+        else if (c >= 0xF1 && c <= 0xF3) { n = 3; }
+        else if (c == 0xF4)              { n = 3; hi = 0x8F; }
+        else                             { return false; }
+
+        for (; n != 0; --n, lo = 0x80, hi = 0xBF) {
+            if (i == last) { return false; }
+            const unsigned d = static_cast<unsigned char>(*i++);
+            if (d < lo || d > hi) { return false; }
+        }
+    }
+    return true;
+}
+
+#if defined(_SCAN_SSSE3)
+// Error bits of 16 bytes following prev, the lookup scheme of Keiser and Lemire: the high nibble of the byte in front,
+// its low nibble and the high nibble of the byte itself each select the errors they allow, whatever survives all
+// three lookups is one. Three and four byte sequences are checked by the bytes two and three places ahead.
+_SCAN_SSSE3_TARGET inline __m128i _Utf8_block_errors(__m128i prev, __m128i input) {
+    constexpr char too_short = 1 << 0, too_long = 1 << 1, overlong_3 = 1 << 2, too_large = 1 << 3;
+    constexpr char surrogate = 1 << 4, overlong_2 = 1 << 5, too_large_1000 = 1 << 6, overlong_4 = 1 << 6;
+    constexpr char two_conts = static_cast<char>(1 << 7);
+    constexpr char carry     = too_short | too_long | two_conts;
+
+    const __m128i nibble = _mm_set1_epi8(0x0F);
+    const __m128i prev1  = _mm_alignr_epi8(input, prev, 15);
+
+    const __m128i byte_1_high = _mm_shuffle_epi8(_mm_setr_epi8(
+        too_long, too_long, too_long, too_long, too_long, too_long, too_long, too_long,
+        two_conts, two_conts, two_conts, two_conts,
+        too_short | overlong_2, too_short, too_short | overlong_3 | surrogate,
+        too_short | too_large | too_large_1000 | overlong_4), _mm_and_si128(_mm_srli_epi16(prev1, 4), nibble));
+    const __m128i byte_1_low = _mm_shuffle_epi8(_mm_setr_epi8(
+        carry | overlong_3 | overlong_2 | overlong_4, carry | overlong_2, carry, carry,
+        carry | too_large, carry | too_large | too_large_1000, carry | too_large | too_large_1000, carry | too_large | too_large_1000,
+        carry | too_large | too_large_1000, carry | too_large | too_large_1000, carry | too_large | too_large_1000,
+        carry | too_large | too_large_1000, carry | too_large | too_large_1000, carry | too_large | too_large_1000 | surrogate,
+        carry | too_large | too_large_1000, carry | too_large | too_large_1000), _mm_and_si128(prev1, nibble));
+    const __m128i byte_2_high = _mm_shuffle_epi8(_mm_setr_epi8(
+        too_short, too_short, too_short, too_short, too_short, too_short, too_short, too_short,
+        too_long | overlong_2 | two_conts | overlong_3 | too_large_1000 | overlong_4,
+        too_long | overlong_2 | two_conts | overlong_3 | too_large,
+        too_long | overlong_2 | two_conts | surrogate | too_large,
+        too_long | overlong_2 | two_conts | surrogate | too_large,
+        too_short, too_short, too_short, too_short), _mm_and_si128(_mm_srli_epi16(input, 4), nibble));
+    const __m128i special = _mm_and_si128(_mm_and_si128(byte_1_high, byte_1_low), byte_2_high);
+
+    // Only 111xxxxx two bytes back or 1111xxxx three bytes back leave the top bit set, such bytes must continue.
+    const __m128i third  = _mm_subs_epu8(_mm_alignr_epi8(input, prev, 14), _mm_set1_epi8(static_cast<char>(0xE0 - 0x80)));
+    const __m128i fourth = _mm_subs_epu8(_mm_alignr_epi8(input, prev, 13), _mm_set1_epi8(static_cast<char>(0xF0 - 0x80)));
+    const __m128i must23 = _mm_and_si128(_mm_or_si128(third, fourth), _mm_set1_epi8(static_cast<char>(0x80)));
+    return _mm_xor_si128(must23, special);
+}
+
+// Errors of the blocks seen so far, ASCII blocks behind ASCII blocks are passed over.
+struct _Utf8_state {
+    __m128i prev;
+    __m128i errors;
+    bool    ascii;
+
+    _SCAN_SSSE3_TARGET void step(__m128i input) {
+        const bool block_ascii = _mm_movemask_epi8(input) == 0;
+        if (!block_ascii || !ascii) { errors = _mm_or_si128(errors, _Utf8_block_errors(prev, input)); }
+        ascii = block_ascii;
+        prev  = input;
+    }
+};
+
+_SCAN_SSSE3_TARGET inline bool _Valid_utf8_ssse3(const char* first, const char* last) {
+    _Utf8_state state{ _mm_setzero_si128(), _mm_setzero_si128(), true };
+    for (; last - first >= 16; first += 16) { state.step(_mm_loadu_si128(reinterpret_cast<const __m128i*>(first))); }
+    if (first != last) {
+        char tail[16] = {};
+        std::memcpy(tail, first, static_cast<std::size_t>(last - first));
+        state.step(_mm_loadu_si128(reinterpret_cast<const __m128i*>(tail)));
+    }
+    // A sequence cut off by the end shows up against the zeros behind it.
+    state.step(_mm_setzero_si128());
+    return _mm_movemask_epi8(_mm_cmpeq_epi8(state.errors, _mm_setzero_si128())) == 0xFFFF;
+}
+#endif
+
+// _Valid_utf8_units over contiguous text, 16 bytes per step where SSSE3 is there, else ASCII words are skipped.
+inline bool _Valid_utf8(const char* first, const char* last) {
+#if defined(_SCAN_SSSE3)
+    if (_Scn_has_ssse3()) { return _Valid_utf8_ssse3(first, last); }
+#endif
+    for (; last - first >= 8; first += 8) {
+        if (_Swar_load(first) & _Swar_high) { break; }
+    }
+    return _Valid_utf8_units(first, last);
+}
+
+// End of a string token: the run of class members for '[' fields, otherwise everything up to whitespace.
+template <class Rng, typename CharT>
+auto _Scan_token(const Rng& rng, const _Basic_scn_specs<CharT>& specs) {
+    using unsigned_type = std::make_unsigned_t<CharT>;
+    if constexpr (_Scn_bytes<Rng>) {
+        const char* first = _Scn_bytes_of(rng);
+        const char* last  = first + std::ranges::size(rng);
+        if (specs.type == '[') { return std::next(rng.begin(), _Span_charset(specs.charset, first, last)); }
+        return std::next(rng.begin(), _Span_spaces<false>(first, last));
+    }
+    else {
+        auto i = rng.begin();
+        if (specs.type == '[') { for (; i != rng.end() && specs.charset.test(static_cast<unsigned_type>(*i)); ++i) {} }
+        else                   { for (; i != rng.end() && !_Is_space(static_cast<unsigned_type>(*i)); ++i) {} }
+        return i;
+    }
+}
+
+// char8_t text is UTF-8 by its type, so its string fields are validated. Other code units are taken as they are.
+template <class Rng>
+bool _Scn_valid_text(const Rng& rng, std::ranges::iterator_t<const Rng> last) {
+    if constexpr (std::same_as<std::ranges::range_value_t<Rng>, char8_t>) {
+        if constexpr (_Scn_bytes<Rng>) { return _Valid_utf8(_Scn_bytes_of(rng), _Scn_bytes_of(rng) + (last - rng.begin())); }
+        else                           { return _Valid_utf8_units(rng.begin(), last); }
+    }
+    else { return true; }
+}
+
+// {:L} numbers with the separators of the context's numpunct. The digits are gathered into a buffer with the
+// thousands separators dropped and the decimal point turned into '.', then the plain kernels convert them.
+// Separators only count between digits, the exponent is taken only when digits follow it.
+template <typename Ty, class Rng, typename CharT>
+std::expected<std::ranges::iterator_t<Rng>, std::p1729r3::scan_error> _Scan_localized(const std::p1729r3::_Scn_numpunct<CharT>& np,
+                                                                                     const Rng& rng, Ty* ptr) {
+    using unsigned_type = std::make_unsigned_t<std::ranges::range_value_t<Rng>>;
+
+    char        small[128];
+    std::string large;
+    std::size_t n = 0;
+    auto put = [&](char c) {
+        if (n < sizeof(small)) { small[n++] = c; return; }
+        if (n == sizeof(small)) { large.assign(small, n); }
+        large.push_back(c);
+        ++n;
+    };
+
+    auto       i     = rng.begin();
+    const auto last  = rng.end();
+    auto digit  = [&](auto j) { return j != last && static_cast<unsigned_type>(*j) - unsigned{ '0' } < 10; };
+    auto digits = [&] {
+        std::size_t k = 0;
+        for (;;) {
+            if (digit(i)) { put(static_cast<char>(*i)); ++i; ++k; continue; }
+            if (np.grouped && k != 0 && i != last && *i == np.thousands && digit(std::next(i))) { ++i; continue; }
+            return k;
+        }
+    };
+
+    if (i != last && (*i == '-' || *i == '+')) {
+        if (*i == '-') { put('-'); }
+        ++i;
+    }
+    std::size_t k = digits();
+    if constexpr (std::floating_point<Ty>) {
+        if (i != last && *i == np.decimal && (k != 0 || digit(std::next(i)))) {
+            put('.');
+            ++i;
+            for (; digit(i); ++i, ++k) { put(static_cast<char>(*i)); }
+        }
+        if (k != 0 && i != last && (*i == 'e' || *i == 'E')) {
+            auto j = std::next(i);
+            const bool sign = j != last && (*j == '+' || *j == '-');
+            if (sign) { ++j; }
+            if (digit(j)) {
+                put('e');
+                if (sign) { put(static_cast<char>(*std::next(i))); }
+                for (i = j; digit(i); ++i) { put(static_cast<char>(*i)); }
+            }
+        }
+    }
+    if (k == 0) { return _SCAN_UNEXPECT(invalid_scanned_value, "Invalid localized number!"); }
+
+    const char* first = n > sizeof(small) ? large.data() : small;
+    Ty v{};
+    if constexpr (std::floating_point<Ty>) {
+        const auto res = std::from_chars(first, first + n, v, std::chars_format::general);
+        if (res.ec == std::errc::result_out_of_range) { return _SCAN_UNEXPECT(value_out_of_range, "Localized number is out of range!"); }
+        if (res.ec != std::errc{})                    { return _SCAN_UNEXPECT(invalid_scanned_value, "Invalid localized number!"); }
+    }
+    else {
+        const auto res = _Parse_integer(first, first + n, v);
+        if (!res.has_value()) {
+            if (res.error().code == std::p1729r3::scan_error::value_out_of_range) { return _SCAN_UNEXPECT(value_out_of_range, "Localized number is out of range!"); }
+            return std::unexpected(res.error());
+        }
+    }
+    if (ptr) { *ptr = v; }
+    return i;
+}
+
+// Converts the value at the front of rng, which _Scan_basic already cut down to the field's width.
+template <typename Ty, class Rng, class Context>
+std::expected<std::ranges::iterator_t<Rng>, std::p1729r3::scan_error> _Scan_value(const Context& sctx, const Rng& rng, Ty* ptr,
+                                                                                 const _Basic_scn_specs<typename Context::char_type>& specs) {
+    using char_type = typename Context::char_type;
+    namespace ranges = std::ranges;
+
+    if constexpr (std::is_same_v<Ty, bool>) {
+        return std::unexpected(std::p1729r3::scan_error(std::p1729r3::scan_error::invalid_scanned_value, "does not support now!"));
+    }
+    // A locale that reads numbers like "C" (and hex or binary fields) takes the plain path below.
+    if constexpr ((std::integral<Ty> && !std::is_same_v<Ty, bool>) || std::floating_point<Ty>) {
+        if (specs.localized && (std::floating_point<Ty> ? specs.type != 'a' && specs.type != 'A' : _Scn_base(specs.type) == 10)) {
+            if (const auto& np = sctx._Numpunct(); !np.plain) { return _Scan_localized(np, rng, ptr); }
+        }
+    }
+    if constexpr (std::integral<Ty> && !std::is_same_v<Ty, bool>) {
+        // Boolean value only contains true or false.
+        Ty v = 0;
+        if constexpr (_Scn_bytes<Rng>) {
+            // Convert in place, no copy.
+            const char* first = _Scn_bytes_of(rng);
+            auto        res   = _Parse_integer(first, first + ranges::size(rng), v, _Scn_base(specs.type));
+            if (!res.has_value()) { return std::unexpected(res.error()); }
+            // Check whether we should write in this value.
+            if (ptr) { *ptr = v; }
+            return std::next(rng.begin(), res.value() - first);
+        }
+        else {
+            auto res = _Parse_integer(rng.begin(), rng.end(), v, _Scn_base(specs.type));
+            if (!res.has_value()) { return std::unexpected(res.error()); }
+            if (ptr) { *ptr = v; }
+            return res.value();
+        }
+    }
+    if constexpr (std::floating_point<Ty>) {
+        Ty v = 0;
+        if constexpr (_Scn_bytes<Rng>) {
+            const char* first = _Scn_bytes_of(rng);
+            auto        res   = _Parse_float(first, first + ranges::size(rng), v, specs.type);
+            if (!res.has_value()) { return std::unexpected(res.error()); }
+            if (ptr) { *ptr = v; }
+            return std::next(rng.begin(), res.value() - first);
+        }
+        else {
+            // from_chars needs contiguous characters, gather the token and keep it on the stack when it's short.
+            char        small[64];
+            std::string large;
+            std::size_t n = 0;
+            for (auto i = rng.begin(); i != rng.end() && _Is_float_char(static_cast<unsigned>(*i)); ++i, ++n) {
+                if (n < sizeof(small))   { small[n] = static_cast<char>(*i); continue; }
+                if (n == sizeof(small))  { large.assign(small, n); }
+                large.push_back(static_cast<char>(*i));
+            }
+            const char* first = n > sizeof(small) ? large.data() : small;
+            auto        res   = _Parse_float(first, first + n, v, specs.type);
+            if (!res.has_value()) { return std::unexpected(res.error()); }
+            if (ptr) { *ptr = v; }
+            return std::next(rng.begin(), res.value() - first);
+        }
+    }
+    if constexpr (std::is_same_v<Ty, void*>) {
+        return std::unexpected(std::p1729r3::scan_error(std::p1729r3::scan_error::invalid_scanned_value, "does not support now!"));
+    }
+    // Input char should be allocated first!
+    if constexpr (std::is_same_v<Ty, char_type*>) {
+        return std::unexpected(std::p1729r3::scan_error(std::p1729r3::scan_error::invalid_scanned_value, "does not support now!"));
+    }
+    if constexpr (std::is_same_v<Ty, std::basic_string<char_type>> || std::is_same_v<Ty, std::pmr::basic_string<char_type>>) {
+        auto last = _Scan_token(rng, specs);
+        if (last == rng.begin()) { return _SCAN_UNEXPECT(invalid_scanned_value, "Empty string field!"); }
+        if (!_Scn_valid_text(rng, last)) { return _SCAN_UNEXPECT(invalid_scanned_value, "String field isn't valid UTF-8!"); }
+        if (ptr) { ptr->assign(rng.begin(), last); }
+        return last;
+    }
+    // Borrowed slice of the source, the caller keeps the input alive as long as the view is used.
+    if constexpr (std::is_same_v<Ty, std::basic_string_view<char_type>>) {
+        if constexpr (_Scn_contiguous<Rng, char_type>) {
+            auto last = _Scan_token(rng, specs);
+            if (last == rng.begin()) { return _SCAN_UNEXPECT(invalid_scanned_value, "Empty string field!"); }
+            if (!_Scn_valid_text(rng, last)) { return _SCAN_UNEXPECT(invalid_scanned_value, "String field isn't valid UTF-8!"); }
+            if (ptr) { *ptr = std::basic_string_view<char_type>{ ranges::data(rng), static_cast<std::size_t>(last - rng.begin()) }; }
+            return last;
+        }
+        else {
+            return _SCAN_UNEXPECT(invalid_scanned_value, "string_view fields need a contiguous range!");
+        }
+    }
+}
+
+// Skips repetitions of the fill code point.
+template <typename It, typename Se, typename CharT>
+It _Skip_fill(It i, Se last, const _Basic_scn_specs<CharT>& specs) {
+    for (;;) {
+        auto j = i;
+        for (std::uint8_t k = 0; k < specs.fill_length; ++k, ++j) {
+            if (j == last || *j != specs.fill[k]) { return i; }
+        }
+        i = j;
+    }
+}
+
+// A field takes at most width code units, fill included. Fill is skipped in front of right aligned and centered
+// values and behind left aligned and centered ones.
+template <typename Ty, class Context>
+std::p1729r3::basic_scanner_result_type<Context> _Scan_basic(const Context& sctx, Ty* ptr, 
+                                                             const _Basic_scn_specs<typename Context::char_type>& specs) {
+    _SCAN_STATS(_Scn_field_timer _Scn_timer{ std::p1729r3::_Scn_arg_type_of<Ty, Context> };)
+    auto rng = sctx.range();
+    if (specs.width == 0 && specs.alignment == _Scn_align::_None) { return _Scan_value(sctx, rng, ptr, specs); }
+
+    auto field = [&](auto sub) -> std::p1729r3::basic_scanner_result_type<Context> {
+        using sub_type = decltype(sub);
+        if (specs.alignment == _Scn_align::_Right || specs.alignment == _Scn_align::_Center) {
+            sub = sub_type{ _Skip_fill(sub.begin(), sub.end(), specs), sub.end() };
+        }
+        auto res = _Scan_value(sctx, sub, ptr, specs);
+        if (!res.has_value()) { return res; }
+        if (specs.alignment == _Scn_align::_Left || specs.alignment == _Scn_align::_Center) {
+            return _Skip_fill(res.value(), sub.end(), specs);
+        }
+        return res;
+    };
+    if (specs.width > 0) { return field(std::ranges::subrange(rng.begin(), std::ranges::next(rng.begin(), specs.width, rng.end()))); }
+    return field(rng);
+}
+
+// Stamps a failure with where it happened, the offset counts from first.
+template <class Context>
+std::p1729r3::scan_error _Scn_located(std::p1729r3::scan_error e, const Context& ctx, const typename Context::iterator& first,
+                                      std::size_t field) {
+    e.offset = static_cast<std::size_t>(std::ranges::distance(first, ctx.current()));
+    e.field  = field;
+    return e;
+}
+
+// Builtin types _Scan_basic can convert today, lowering a pattern rejects fields of any other builtin type.
+constexpr bool _Scn_type_supported(std::p1729r3::_Scn_arg_type type) {
+    using enum std::p1729r3::_Scn_arg_type;
+    switch (type) {
+    case _Signed_i8:   case _Signed_i16:   case _Signed_i32:   case _Signed_i64:   case _Signed_long:
+    case _Unsigned_i8: case _Unsigned_i16: case _Unsigned_i32: case _Unsigned_i64: case _Unsigned_long:
+    case _Float32:     case _Float64:      case _Float_ext:
+    case _Std_string:  case _Std_string_view: case _Pmr_string: case _Custom:
+        return true;
+    default:
+        return false;
+    }
+}
+
+// Whether the presentation type and the L flag of a field fit the builtin type it scans into.
+template <typename CharT>
+constexpr bool _Scn_specs_supported(const _Basic_scn_specs<CharT>& specs, std::p1729r3::_Scn_arg_type type) {
+    using enum std::p1729r3::_Scn_arg_type;
+    const bool floating = type == _Float32 || type == _Float64 || type == _Float_ext;
+    const bool integral = type != _None && type < _Float32;
+    if (specs.localized && !floating && !integral && type != _Custom) { return false; }
+
+    switch (specs.type) {
+    case '\0':
+        return true;
+    case 'a': case 'A': case 'e': case 'E': case 'f': case 'F': case 'g': case 'G':
+        return floating || type == _Custom;
+    case 'd': case 'x': case 'X': case 'o': case 'b': case 'B':
+        return integral || type == _Custom;
+    case '[':
+        return type == _Std_string || type == _Std_string_view || type == _Pmr_string || type == _Custom;
+    default:
+        return type == _Custom;
+    }
+}
+
+template <class Context>
+struct _Arg_visitor {
+    using char_type   = typename Context::char_type;
+    using iterator    = typename Context::iterator;
+    using result_type = std::expected<iterator, std::p1729r3::scan_error>;
+
+    Context&                                            sctx;
+    std::p1729r3::basic_scan_parse_context<char_type>&  pctx;
+
+    result_type operator()(std::monostate) const { return _SCAN_UNEXPECT(invalid_format_string, "Argument id out of range!"); }
+    template <typename Ty>
+    result_type operator()(Ty* p) {
+        _Basic_scn_specs<char_type> specs;
+        auto pres = _Parse_basic(pctx, specs);
+        if (pres.has_value()) { pctx.advance_to(pres.value()); }
+        else { return std::unexpected(pres.error()); }
+        if (!_Scn_specs_supported(specs, std::p1729r3::_Scn_arg_type_of<Ty, Context>)) {
+            return _SCAN_UNEXPECT(invalid_format_string, "Presentation type doesn't fit the argument!");
+        }
+        return _Scan_basic(sctx, p, specs);
+    }
+    result_type operator()(typename std::p1729r3::basic_scan_arg<Context>::handle& hd) {
+        _SCAN_STATS(_Scn_field_timer _Scn_timer{ std::p1729r3::_Scn_arg_type::_Custom };)
+        auto result = hd.scan(pctx, sctx);
+        if (result) { return  sctx.current(); }
+        return std::unexpected(result);
+    }
+};
+
+// Interprets a runtime pattern. loc is what {:L} fields read with, null for the global locale.
+template <class Rng, typename CharT>
+std::p1729r3::vscan_result_type<Rng> _Vscan(const std::locale* loc, Rng rg, std::basic_string_view<CharT> fmt,
+                                            std::p1729r3::basic_scan_args<std::p1729r3::basic_scan_context<Rng, CharT>> args) {
+    using context_type = std::p1729r3::basic_scan_context<Rng, CharT>;
+
+    context_type                                   ctx{ rg, args, loc, std::pmr::get_default_resource() };
+    std::p1729r3::basic_scan_parse_context<CharT>  ptx{ fmt, args.size()};
+    _Scn_arg_ids                                   ids;
+    _SCAN_STATS(_Scn_stats_scope _Scn_scope{ ctx, fmt };)
+
+    const auto  first = ctx.current();
+    std::size_t field = 0;
+
+    auto pc = ptx.begin();
+    auto sc = ctx.current();
+
+    for (; pc != ptx.end(); pc = ptx.begin(), sc = ctx.current()) {
+        const bool eof = sc == ctx.range().end();
+        // Whitespace on either side is insignificant, a whole run of the input goes at once.
+        const bool pattern_space = _Is_space_unit(*pc);
+        const bool input_space   = !eof && _Is_space_unit(*sc);
+        if (pattern_space) { ptx.advance_to(std::next(pc)); }
+        if (input_space)   { ctx.advance_to(_Skip_space_run(sc, ctx.range().end())); }
+
+        if (!pattern_space && !input_space) {
+            // A brace that ends the pattern is no escape: '{' is an unterminated field, '}' an invalid escape.
+            if (*pc == '{') {
+                if (std::next(pc) != ptx.end() && *std::next(pc) == '{') {
+                    if (!eof && *sc == '{') {
+                        ptx.advance_to(std::next(pc, 2));
+                        ctx.advance_to(std::next(sc));
+                    } else goto scan_mismatch;
+                }
+                // Value should be scan in.
+                else {
+                    auto v = _Get_scan_replacement(ptx, ids);
+                    if (v.has_value()) {
+                        ptx.advance_to(std::get<0>(v.value()));
+
+                        auto k = ctx.arg(std::get<1>(v.value())).visit(_Arg_visitor<context_type>{ctx, ptx});
+                        if (k.has_value()) { ctx.advance_to(k.value()); ++field; }
+                        else { _SCAN_STATS(_Scn_scope.fail(k.error());) return std::unexpected(_Scn_located(k.error(), ctx, first, field)); }
+                    }
+                    else { _SCAN_STATS(_Scn_scope.fail(v.error());) return std::unexpected(_Scn_located(v.error(), ctx, first, field)); }
+                }
+            }
+            else if (*pc == '}') {
+                if (std::next(pc) != ptx.end() && *std::next(pc) == '}') {
+                    if (!eof && *sc == '}') {
+                        ptx.advance_to(std::next(pc, 2));
+                        ctx.advance_to(std::next(sc));
+                    } else goto scan_mismatch;
+                }
+                else {
+                    std::p1729r3::scan_error err{ std::p1729r3::scan_error::invalid_format_string, "Invalid escape code }" };
+                    _SCAN_STATS(_Scn_scope.fail(err);)
+                    return std::unexpected(_Scn_located(err, ctx, first, field));
+                }
+            }
+            // The whole run up to the next brace or whitespace is compared at once.
+            else {
+                auto run = pc;
+                while (run != ptx.end() && !_Is_space_unit(*run) && *run != '{' && *run != '}') { ++run; }
+                const bool matched = _Match_segment(sc, ctx.range().end(), std::to_address(pc), static_cast<std::size_t>(run - pc));
+                ctx.advance_to(sc);
+                if (!matched) goto scan_mismatch;
+                ptx.advance_to(run);
+            }
+        }
+    }
+    return _Scn_borrow<Rng>(ctx.range());
+    scan_mismatch:
+    _SCAN_STATS(_Scn_scope.mismatch();)
+    return _Scn_borrow<Rng>(ctx.range());
+}
+
+// Any code unit type: literals and numbers are matched on the code units of the range, nothing is transcoded.
+template <class Rng, typename CharT> requires std::p1729r3::scannable_range<Rng, CharT>
+std::p1729r3::vscan_result_type<Rng> format_from(Rng rg, std::type_identity_t<std::basic_string_view<CharT>> fmt,
+                                                 std::p1729r3::basic_scan_args<std::p1729r3::basic_scan_context<Rng, CharT>> args) {
+    return _Vscan<Rng, CharT>(nullptr, rg, fmt, args);
+}
+
+// A literal run of a pattern split into the segments _Match_segment compares in bulk: the runs without whitespace,
+// an escaped brace ends its segment after the first half. Offsets index the pattern string, a run with more
+// segments than fit is walked by _Match_literal instead.
+struct _Scn_literal {
+    struct segment {
+        std::uint32_t begin = 0;
+        std::uint32_t size  = 0;
+    };
+    static constexpr std::size_t capacity = 8;
+
+    std::size_t                       begin    = 0;
+    std::size_t                       end      = 0;
+    std::array<segment, capacity>     segments{};
+    std::uint8_t                      count    = 0;
+    bool                              overflow = false;
+    bool                              trailing = false; // Ends with whitespace, which consumes the input run.
+};
+
+template <typename CharT>
+constexpr _Scn_literal _Lower_literal(std::basic_string_view<CharT> fmt, std::size_t begin, std::size_t end) {
+    _Scn_literal lit{ begin, end };
+    for (std::size_t i = begin; i < end;) {
+        if (_Is_space_unit(fmt[i])) { lit.trailing = true; ++i; continue; }
+
+        std::size_t j = i;
+        while (j < end && !_Is_space_unit(fmt[j]) && fmt[j] != '{' && fmt[j] != '}') { ++j; }
+        const std::size_t next = j < end && !_Is_space_unit(fmt[j]) ? j + 2 : j;
+        if (next != j) { ++j; }
+
+        if (lit.count == _Scn_literal::capacity) { lit.overflow = true; break; }
+        lit.segments[lit.count++] = { static_cast<std::uint32_t>(i), static_cast<std::uint32_t>(j - i) };
+        lit.trailing = false;
+        i = next;
+    }
+    return lit;
+}
+
+// A replacement field lowered out of a pattern: the literal run in front of it plus its already parsed specs.
+template <typename CharT>
+struct _Scn_field_op {
+    _Scn_literal                  lit;
+    std::size_t                   spec_begin = 0; // ':' or '}' of the field, custom scanners parse from here.
+    std::size_t                   arg_id     = 0;
+    std::p1729r3::_Scn_arg_type   type       = std::p1729r3::_Scn_arg_type::_None;
+    _Basic_scn_specs<CharT>       specs;
+};
+
+// Walks a pattern once and hands every replacement field to on_field, returns the trailing literal.
+template <typename CharT, typename OnField>
+constexpr std::expected<_Scn_literal, std::p1729r3::scan_error> _Lower_scan_pattern(std::basic_string_view<CharT> fmt,
+                                                                                  std::size_t nargs, OnField&& on_field) {
+    std::p1729r3::basic_scan_parse_context<CharT> ptx{ fmt, nargs };
+    _Scn_arg_ids                                  ids;
+    std::size_t lit = 0;
+
+    for (std::size_t i = 0; i < fmt.size();) {
+        if (fmt[i] == '{' && i + 1 < fmt.size() && fmt[i + 1] == '{') { i += 2; continue; }
+        if (fmt[i] == '}') {
+            if (i + 1 < fmt.size() && fmt[i + 1] == '}') { i += 2; continue; }
+            return _SCAN_UNEXPECT(invalid_format_string, "Invalid escape code }");
+        }
+        if (fmt[i] != '{') { ++i; continue; }
+
+        _Scn_field_op<CharT> op;
+        op.lit = _Lower_literal(fmt, lit, i);
+
+        ptx.advance_to(std::next(fmt.begin(), i));
+        auto v = _Get_scan_replacement(ptx, ids);
+        if (!v.has_value()) { return std::unexpected(v.error()); }
+        ptx.advance_to(std::get<0>(v.value()));
+        op.spec_begin = static_cast<std::size_t>(std::get<0>(v.value()) - fmt.begin());
+        op.arg_id     = std::get<1>(v.value());
+        if (op.arg_id >= nargs) { return _SCAN_UNEXPECT(invalid_format_string, "Argument id out of range!"); }
+
+        auto pres = _Parse_basic(ptx, op.specs);
+        if (!pres.has_value()) { return std::unexpected(pres.error()); }
+        i = lit = static_cast<std::size_t>(pres.value() - fmt.begin());
+
+        if (auto e = on_field(op); !e) { return std::unexpected(e); }
+    }
+    return _Lower_literal(fmt, lit, fmt.size());
+}
+
+// Not constexpr on purpose: reaching it while lowering a basic_scan_format_string makes the build fail.
+inline void _Invalid_scan_format_string(std::string_view) noexcept {}
+
+namespace std::p1729r3 {
+// Pattern checked against its argument types and lowered into a fixed plan at compile time.
+template <typename CharT, typename ... Args>
+class basic_scan_format_string {
+    using _Check_context = std::p1729r3::basic_scan_context<std::basic_string_view<CharT>, CharT>;
+public:
+    template <typename Ty> requires std::convertible_to<const Ty&, std::basic_string_view<CharT>>
+    consteval basic_scan_format_string(const Ty& s) : str_(s) {
+        if (auto e = _Lower(); !e) { _Invalid_scan_format_string(e.msg); }
+    }
+
+    // What the constructor would reject s for, without failing the build. Good when s is accepted.
+    static constexpr std::p1729r3::scan_error _Validate(std::basic_string_view<CharT> s) {
+        basic_scan_format_string f;
+        f.str_ = s;
+        return f._Lower();
+    }
+
+    constexpr std::basic_string_view<CharT>          get()        const noexcept { return str_; }
+    constexpr std::span<const _Scn_field_op<CharT>>  fields()     const noexcept { return { ops_.data(), size_ }; }
+    constexpr const _Scn_literal&                    tail()       const noexcept { return tail_; }
+    // Every argument is scanned once and the k-th field scans the k-th argument.
+    constexpr bool                                   sequential() const noexcept { return sequential_; }
+private:
+    constexpr basic_scan_format_string() = default;
+
+    constexpr std::p1729r3::scan_error _Lower() {
+        constexpr std::p1729r3::_Scn_arg_type types[sizeof...(Args) + 1] = { std::p1729r3::_Scn_arg_type_of<Args, _Check_context>... };
+        bool used[sizeof...(Args) + 1] = {};
+
+        auto res = _Lower_scan_pattern(str_, sizeof...(Args), [&](_Scn_field_op<CharT> op) {
+            if (used[op.arg_id])                   { return std::p1729r3::scan_error{ std::p1729r3::scan_error::invalid_format_string, "Argument is scanned more than once!" }; }
+            if (!_Scn_type_supported(types[op.arg_id])) { return std::p1729r3::scan_error{ std::p1729r3::scan_error::invalid_format_string, "Argument type can't be scanned!" }; }
+            if (!_Scn_specs_supported(op.specs, types[op.arg_id])) { return std::p1729r3::scan_error{ std::p1729r3::scan_error::invalid_format_string, "Presentation type doesn't fit the argument!" }; }
+            used[op.arg_id] = true;
+            op.type         = types[op.arg_id];
+            ops_[size_++]   = op;
+            return std::p1729r3::scan_error{ std::p1729r3::scan_error::good, "" };
+        });
+        if (!res.has_value()) { return res.error(); }
+        tail_ = res.value();
+
+        sequential_ = size_ == sizeof...(Args);
+        for (std::size_t k = 0; k < size_; ++k) { sequential_ = sequential_ && ops_[k].arg_id == k; }
+        return std::p1729r3::scan_error{ std::p1729r3::scan_error::good, "" };
+    }
+
+    std::basic_string_view<CharT>                        str_;
+    std::array<_Scn_field_op<CharT>, sizeof...(Args)>    ops_{};
+    std::size_t                                          size_       = 0;
+    _Scn_literal                                         tail_;
+    bool                                                 sequential_ = false;
+};
+} //! namespace std::p1729r3
+
+// Whitespace is insignificant on both sides like in format_from, whitespace in the literal consumes the whole input
+// run as in scanf. A doubled brace compares as one.
+template <class Context, typename CharT>
+bool _Match_literal(Context& ctx, std::basic_string_view<CharT> lit) {
+    auto rng = ctx.range();
+    auto sc  = rng.begin();
+    for (auto pc = lit.begin(); pc != lit.end();) {
+        if (_Is_space_unit(*pc)) { sc = _Skip_space_run(sc, rng.end()); ++pc; continue; }
+
+        auto run = pc;
+        while (run != lit.end() && !_Is_space_unit(*run) && *run != '{' && *run != '}') { ++run; }
+        const bool brace = run != lit.end() && !_Is_space_unit(*run);
+        if (brace) { ++run; }
+
+        if (!_Match_segment(sc, rng.end(), std::to_address(pc), static_cast<std::size_t>(run - pc))) { ctx.advance_to(sc); return false; }
+        pc = brace ? std::next(run) : run;
+    }
+    ctx.advance_to(sc);
+    return true;
+}
+
+// The same match over the segments lowered ahead of time.
+template <class Context, typename CharT>
+bool _Match_literal(Context& ctx, std::basic_string_view<CharT> fmt, const _Scn_literal& lit) {
+    if (lit.overflow) { return _Match_literal(ctx, fmt.substr(lit.begin, lit.end - lit.begin)); }
+
+    auto rng = ctx.range();
+    auto sc  = rng.begin();
+    for (std::size_t k = 0; k < lit.count; ++k) {
+        const auto& seg = lit.segments[k];
+        if (!_Match_segment(sc, rng.end(), fmt.data() + seg.begin, seg.size)) { ctx.advance_to(sc); return false; }
+    }
+    if (lit.trailing) { sc = _Skip_space_run(sc, rng.end()); }
+    ctx.advance_to(sc);
+    return true;
+}
+
+template <class Context>
+void _Skip_spaces(Context& ctx) {
+    auto rng = ctx.range();
+    ctx.advance_to(_Skip_space_run(rng.begin(), rng.end()));
+}
+
+template <class Context>
+struct _Op_visitor {
+    using char_type   = typename Context::char_type;
+    using iterator    = typename Context::iterator;
+    using result_type = std::expected<iterator, std::p1729r3::scan_error>;
+
+    Context&                                sctx;
+    std::basic_string_view<char_type>       fmt;
+    const _Scn_field_op<char_type>&         op;
+
+    result_type operator()(std::monostate) const { return _SCAN_UNEXPECT(invalid_format_string, "Argument id out of range!"); }
+    template <typename Ty>
+    result_type operator()(Ty* p) { return _Scan_basic(sctx, p, op.specs); }
+    result_type operator()(typename std::p1729r3::basic_scan_arg<Context>::handle& hd) {
+        _SCAN_STATS(_Scn_field_timer _Scn_timer{ std::p1729r3::_Scn_arg_type::_Custom };)
+        std::p1729r3::basic_scan_parse_context<char_type> pctx{ fmt.substr(op.spec_begin) };
+        auto result = hd.scan(pctx, sctx);
+        if (result) { return  sctx.current(); }
+        return std::unexpected(result);
+    }
+};
+
+// How far a pattern got. A pattern that stopped on a literal names the field behind it (the number of fields for
+// the trailing literal) and where the input differs.
+struct _Scn_stop {
+    bool         matched = true;
+    std::size_t  field   = 0;
+    std::size_t  offset  = 0;
+
+    explicit operator bool() const noexcept { return matched; }
+};
+
+template <class Context>
+_Scn_stop _Scn_stopped(const Context& ctx, const typename Context::iterator& first, std::size_t field) {
+    return { false, field, static_cast<std::size_t>(std::ranges::distance(first, ctx.current())) };
+}
+
+// What scan reports for input that doesn't match, nothing is allocated to describe it.
+inline std::p1729r3::scan_error _Scn_mismatch_error(const _Scn_stop& stop) noexcept {
+    return { std::p1729r3::scan_error::invalid_scanned_value, "Input doesn't match the pattern!", stop.offset, stop.field };
+}
+
+// Executes a lowered pattern, nothing here looks at the pattern except the literal runs.
+// Yields how far the pattern matched, the context is left where scanning stopped.
+template <class Rng, typename CharT>
+std::expected<_Scn_stop, std::p1729r3::scan_error> _Exec_scan_plan(std::p1729r3::basic_scan_context<Rng, CharT>& ctx,
+                                                                   std::basic_string_view<CharT> fmt,
+                                                                   std::span<const _Scn_field_op<CharT>> ops, const _Scn_literal& tail) {
+    _SCAN_STATS(_Scn_stats_scope _Scn_scope{ ctx, fmt };)
+    const auto first = ctx.current();
+    for (std::size_t k = 0; k < ops.size(); ++k) {
+        const auto& op = ops[k];
+        if (!_Match_literal(ctx, fmt, op.lit)) {
+            _SCAN_STATS(_Scn_scope.mismatch();)
+            return _Scn_stopped(ctx, first, k);
+        }
+        _Skip_spaces(ctx);
+
+        auto res = ctx.arg(op.arg_id).visit(_Op_visitor<std::p1729r3::basic_scan_context<Rng, CharT>>{ ctx, fmt, op });
+        if (res.has_value()) { ctx.advance_to(res.value()); }
+        else { _SCAN_STATS(_Scn_scope.fail(res.error());) return std::unexpected(_Scn_located(res.error(), ctx, first, k)); }
+    }
+    if (!_Match_literal(ctx, fmt, tail)) { _SCAN_STATS(_Scn_scope.mismatch();) return _Scn_stopped(ctx, first, ops.size()); }
+    return _Scn_stop{};
+}
+
+template <class Rng, typename CharT>
+std::p1729r3::vscan_result_type<Rng> _Run_scan_plan(std::p1729r3::basic_scan_context<Rng, CharT>& ctx, std::basic_string_view<CharT> fmt,
+                                                    std::span<const _Scn_field_op<CharT>> ops, const _Scn_literal& tail) {
+    auto res = _Exec_scan_plan(ctx, fmt, ops, tail);
+    if (!res.has_value()) { return std::unexpected(res.error()); }
+    return _Scn_borrow<Rng>(ctx.range());
+}
+
+// Where a statically typed field writes, skipped arguments are scanned into a null pointer.
+template <typename Ty> constexpr Ty* _Scn_target(Ty& v)                        noexcept { return std::addressof(v); }
+template <typename Ty> constexpr Ty* _Scn_target(std::p1729r3::scan_skip<Ty>&) noexcept { return nullptr; }
+
+// Arguments _Scan_basic converts by itself, fields of these types never need a basic_scan_arg.
+template <typename Ty, class Context>
+concept _Scn_static_arg = std::p1729r3::_Scn_arg_type_of<Ty, Context> != std::p1729r3::_Scn_arg_type::_Custom;
+
+// _Exec_scan_plan for sequential patterns over statically typed arguments: each field calls the converter
+// of its type directly, there is no arg store, no visit and no switch over _Scn_arg_type.
+template <class Context, typename CharT, typename ... Args>
+std::expected<_Scn_stop, std::p1729r3::scan_error> _Exec_scan_static(Context& ctx, std::basic_string_view<CharT> fmt,
+                                                                     std::span<const _Scn_field_op<CharT>> ops, const _Scn_literal& tail,
+                                                                     Args& ... args) {
+    _SCAN_STATS(_Scn_stats_scope _Scn_scope{ ctx, fmt };)
+    const auto first = ctx.current();
+    std::p1729r3::scan_error err{ std::p1729r3::scan_error::good, "" };
+    bool        matched = true;
+    std::size_t k       = 0;
+
+    auto field = [&](const _Scn_field_op<CharT>& op, auto* target) {
+        if (!_Match_literal(ctx, fmt, op.lit)) { matched = false; return false; }
+        _Skip_spaces(ctx);
+
+        auto res = _Scan_basic(ctx, target, op.specs);
+        if (res.has_value()) { ctx.advance_to(res.value()); ++k; return true; }
+        err = res.error();
+        return false;
+    };
+    (field(ops[k], _Scn_target(args)) && ...);
+
+    if (!err)     { _SCAN_STATS(_Scn_scope.fail(err);) return std::unexpected(_Scn_located(err, ctx, first, k)); }
+    if (!matched || !_Match_literal(ctx, fmt, tail)) { _SCAN_STATS(_Scn_scope.mismatch();) return _Scn_stopped(ctx, first, k); }
+    return _Scn_stop{};
+}
+
+// Runs a checked pattern against typed arguments. Patterns that reorder arguments or scan custom types fall
+// back to the type erased plan over the rest of the range.
+template <class Rng, typename CharT, typename ... Args>
+std::expected<_Scn_stop, std::p1729r3::scan_error> _Exec_scan_format(std::p1729r3::basic_scan_context<Rng, CharT>& ctx,
+                                                                     const std::p1729r3::basic_scan_format_string<CharT, Args...>& fmt,
+                                                                     Args& ... args) {
+    if constexpr ((_Scn_static_arg<Args, std::p1729r3::basic_scan_context<Rng, CharT>> && ...)) {
+        if (fmt.sequential()) { return _Exec_scan_static(ctx, fmt.get(), fmt.fields(), fmt.tail(), args...); }
+    }
+    using erased_type = std::p1729r3::basic_scan_context<decltype(ctx.range()), CharT>;
+
+    std::p1729r3::basic_scan_arg_store<erased_type, Args...> store{ args... };
+    erased_type erased{ ctx.range(), std::p1729r3::basic_scan_args<erased_type>{ store }, ctx._Locale_ptr(), ctx.resource() };
+    auto res = _Exec_scan_plan(erased, fmt.get(), fmt.fields(), fmt.tail());
+    ctx.advance_to(erased.current());
+    return res;
+}
+
+template <typename Ty>   inline constexpr bool _Scn_is_args                                        = false;
+template <class Context> inline constexpr bool _Scn_is_args<std::p1729r3::basic_scan_args<Context>> = true;
+
+template <typename Ty>
+concept _Scn_value_arg = !_Scn_is_args<std::remove_cvref_t<Ty>>;
+
+// The pattern has the code unit type of the range: a u"..." pattern for char16_t text, L"..." for wchar_t.
+template <std::ranges::forward_range Rng, _Scn_value_arg ... Args>
+std::p1729r3::vscan_result_type<Rng> format_from(Rng rg, std::p1729r3::basic_scan_format_string<_Scn_char_t<Rng>, std::type_identity_t<Args>...> fmt,
+                                                 Args& ... args) {
+    std::p1729r3::basic_scan_context<Rng, _Scn_char_t<Rng>> ctx{ rg, {} };
+    auto res = _Exec_scan_format(ctx, fmt, args...);
+    if (!res.has_value()) { return std::unexpected(res.error()); }
+    return _Scn_borrow<Rng>(ctx.range());
+}
+
+template <class Rng, typename CharT, class ... Args>
+std::p1729r3::scan_from_result_type<Rng> _Scan_from(const std::locale* loc, Rng&& range,
+                                                    const std::p1729r3::basic_scan_format_string<CharT, Args...>& fmt, Args& ... args) {
+    std::p1729r3::basic_scan_context<std::remove_reference_t<Rng>&, CharT> ctx{ range, {}, loc, std::pmr::get_default_resource() };
+    auto res = _Exec_scan_format(ctx, fmt, args...);
+    if (!res.has_value()) { return std::unexpected(res.error()); }
+    return _Scn_borrow<Rng>(ctx.range());
+}
+
+// Values are scanned straight into the tuple the result carries, unlike scan_from a partial match is an error.
+template <class Rng, typename CharT, class ... Args>
+std::p1729r3::scan_result_type<Rng, Args...> _Scan(const std::locale* loc, std::pmr::memory_resource* resource, Rng&& range,
+                                                   const std::p1729r3::basic_scan_format_string<CharT, Args...>& fmt) {
+    auto values = std::make_obj_using_allocator<std::tuple<Args...>>(std::pmr::polymorphic_allocator<>{ resource });
+    std::p1729r3::basic_scan_context<std::remove_reference_t<Rng>&, CharT> ctx{ range, {}, loc, resource };
+
+    auto res = std::apply([&](Args& ... v) { return _Exec_scan_format(ctx, fmt, v...); }, values);
+    if (!res.has_value()) { return std::unexpected(res.error()); }
+    if (!res.value())     { return std::unexpected(_Scn_mismatch_error(res.value())); }
+    return std::p1729r3::scan_result<std::ranges::borrowed_subrange_t<Rng>, Args...>{ _Scn_borrow<Rng>(ctx.range()), std::move(values) };
+}
+
+namespace std::p1729r3 {
+template <scannable_range<char> Rng>
+vscan_result_type<Rng> vscan(Rng&& range, string_view fmt, scan_args<Rng> args) {
+    return _Vscan<Rng, char>(nullptr, std::forward<Rng>(range), fmt, args);
+}
+
+template <scannable_range<wchar_t> Rng>
+vscan_result_type<Rng> vscan(Rng&& range, wstring_view fmt, wscan_args<Rng> args) {
+    return _Vscan<Rng, wchar_t>(nullptr, std::forward<Rng>(range), fmt, args);
+}
+
+template <scannable_range<char> Rng>
+vscan_result_type<Rng> vscan(const locale& loc, Rng&& range, string_view fmt, scan_args<Rng> args) {
+    return _Vscan<Rng, char>(&loc, std::forward<Rng>(range), fmt, args);
+}
+
+template <scannable_range<wchar_t> Rng>
+vscan_result_type<Rng> vscan(const locale& loc, Rng&& range, wstring_view fmt, wscan_args<Rng> args) {
+    return _Vscan<Rng, wchar_t>(&loc, std::forward<Rng>(range), fmt, args);
+}
+
+template <class ... Args, scannable_range<char> Rng>
+scan_from_result_type<Rng> scan_from(Rng&& range, scan_format_string<Args...> fmt, Args& ... args) {
+    return _Scan_from(nullptr, std::forward<Rng>(range), fmt, args...);
+}
+
+template <class ... Args, scannable_range<wchar_t> Rng>
+scan_from_result_type<Rng> scan_from(Rng&& range, wscan_format_string<Args...> fmt, Args& ... args) {
+    return _Scan_from(nullptr, std::forward<Rng>(range), fmt, args...);
+}
+
+template <class ... Args, scannable_range<char> Rng>
+scan_from_result_type<Rng> scan_from(const locale& loc, Rng&& range, scan_format_string<Args...> fmt, Args& ... args) {
+    return _Scan_from(&loc, std::forward<Rng>(range), fmt, args...);
+}
+
+template <class ... Args, scannable_range<wchar_t> Rng>
+scan_from_result_type<Rng> scan_from(const locale& loc, Rng&& range, wscan_format_string<Args...> fmt, Args& ... args) {
+    return _Scan_from(&loc, std::forward<Rng>(range), fmt, args...);
+}
+
+template <class ... Args, scannable_range<char> Rng>
+scan_result_type<Rng, Args...> scan(pmr::memory_resource* resource, Rng&& range, scan_format_string<Args...> fmt) {
+    return _Scan(nullptr, resource, std::forward<Rng>(range), fmt);
+}
+
+template <class ... Args, scannable_range<wchar_t> Rng>
+scan_result_type<Rng, Args...> scan(pmr::memory_resource* resource, Rng&& range, wscan_format_string<Args...> fmt) {
+    return _Scan(nullptr, resource, std::forward<Rng>(range), fmt);
+}
+
+template <class ... Args, scannable_range<char> Rng>
+scan_result_type<Rng, Args...> scan(Rng&& range, scan_format_string<Args...> fmt) {
+    return _Scan(nullptr, pmr::get_default_resource(), std::forward<Rng>(range), fmt);
+}
+
+template <class ... Args, scannable_range<wchar_t> Rng>
+scan_result_type<Rng, Args...> scan(Rng&& range, wscan_format_string<Args...> fmt) {
+    return _Scan(nullptr, pmr::get_default_resource(), std::forward<Rng>(range), fmt);
+}
+
+template <class ... Args, scannable_range<char> Rng>
+scan_result_type<Rng, Args...> scan(const locale& loc, Rng&& range, scan_format_string<Args...> fmt) {
+    return _Scan(&loc, pmr::get_default_resource(), std::forward<Rng>(range), fmt);
+}
+
+template <class ... Args, scannable_range<wchar_t> Rng>
+scan_result_type<Rng, Args...> scan(const locale& loc, Rng&& range, wscan_format_string<Args...> fmt) {
+    return _Scan(&loc, pmr::get_default_resource(), std::forward<Rng>(range), fmt);
+}
+} //! namespace std::p1729r3
+
+// Runtime patterns learn the argument types only from the scan_args, so their fields are checked once per scan.
+// Ids past the arguments are left to fail when their field is reached.
+template <typename CharT, class Context>
+std::expected<void, std::p1729r3::scan_error> _Check_scan_plan(std::span<const _Scn_field_op<CharT>> ops,
+                                                               const std::p1729r3::basic_scan_args<Context>& args) {
+    for (const auto& op : ops) {
+        const auto type = args.get(op.arg_id).type();
+        if (type != std::p1729r3::_Scn_arg_type::_None && !_Scn_specs_supported(op.specs, type)) {
+            return _SCAN_UNEXPECT(invalid_format_string, "Presentation type doesn't fit the argument!");
+        }
+    }
+    return {};
+}
+
+// Pattern lowered once at runtime (e.g. read from a config file) and reused for any number of scans.
+template <typename CharT>
+class basic_compiled_scan_pattern {
+public:
+    basic_compiled_scan_pattern() = default;
+
+    std::basic_string_view<CharT>          get()           const noexcept { return str_; }
+    std::span<const _Scn_field_op<CharT>>  fields()        const noexcept { return ops_; }
+    const _Scn_literal&                    tail()          const noexcept { return tail_; }
+    // Smallest scan_args size this pattern can run against.
+    std::size_t                            args_required() const noexcept { return nargs_; }
+
+    template <typename OtherCharT>
+    friend std::expected<basic_compiled_scan_pattern<OtherCharT>, std::p1729r3::scan_error>
+    compile_scan_pattern(std::basic_string_view<OtherCharT> fmt);
+private:
+    std::basic_string<CharT>               str_;
+    std::vector<_Scn_field_op<CharT>>      ops_;
+    _Scn_literal                           tail_;
+    std::size_t                            nargs_ = 0;
+};
+
+using  compiled_scan_pattern = basic_compiled_scan_pattern<char>;
+using wcompiled_scan_pattern = basic_compiled_scan_pattern<wchar_t>;
+
+template <typename CharT>
+std::expected<basic_compiled_scan_pattern<CharT>, std::p1729r3::scan_error> compile_scan_pattern(std::basic_string_view<CharT> fmt) {
+    basic_compiled_scan_pattern<CharT> pat;
+    pat.str_ = fmt;
+    // Argument types are unknown here, ids are checked against scan_args when the pattern runs. An argument can
+    // still be scanned only once, like in a basic_scan_format_string.
+    auto res = _Lower_scan_pattern(std::basic_string_view<CharT>{ pat.str_ }, std::numeric_limits<std::size_t>::max(),
+        [&](const _Scn_field_op<CharT>& op) {
+            if (std::ranges::find(pat.ops_, op.arg_id, &_Scn_field_op<CharT>::arg_id) != pat.ops_.end()) {
+                return std::p1729r3::scan_error{ std::p1729r3::scan_error::invalid_format_string, "Argument is scanned more than once!" };
+            }
+            pat.ops_.push_back(op);
+            pat.nargs_ = std::max(pat.nargs_, op.arg_id + 1);
+            return std::p1729r3::scan_error{ std::p1729r3::scan_error::good, "" };
+        });
+    if (!res.has_value()) { return std::unexpected(res.error()); }
+    pat.tail_ = res.value();
+    return pat;
+}
+
+inline std::expected<compiled_scan_pattern, std::p1729r3::scan_error> compile_scan_pattern(std::string_view fmt) {
+    return compile_scan_pattern<char>(fmt);
+}
+
+template <class Rng, typename CharT> requires std::p1729r3::scannable_range<Rng, CharT>
+std::p1729r3::vscan_result_type<Rng> format_from(Rng rg, const basic_compiled_scan_pattern<CharT>& pat,
+                                                 std::p1729r3::basic_scan_args<std::p1729r3::basic_scan_context<Rng, CharT>> args) {
+    if (pat.args_required() > args.size()) { return _SCAN_UNEXPECT(invalid_format_string, "Pattern refers to more arguments than given!"); }
+    if (auto checked = _Check_scan_plan(pat.fields(), args); !checked) { return std::unexpected(checked.error()); }
+    std::p1729r3::basic_scan_context<Rng, CharT> ctx{ rg, args };
+    return _Run_scan_plan(ctx, pat.get(), pat.fields(), pat.tail());
+}
+// Several runtime patterns compiled together for inputs of mixed shapes. Patterns are bucketed by the first code
+// unit of their leading literal, so an input is only run against the patterns its first non whitespace unit can
+// start, plus the ones that open with a field. Candidates are tried in the order the patterns were given.
+template <typename CharT>
+class basic_scan_pattern_set {
+    struct _Bucket {
+        CharT                      unit{};
+        std::vector<std::size_t>   patterns;
+    };
+public:
+    basic_scan_pattern_set() = default;
+
+    std::size_t                                        size()     const noexcept { return patterns_.size(); }
+    const basic_compiled_scan_pattern<CharT>&          operator[](std::size_t i) const noexcept { return patterns_[i]; }
+
+    // Patterns an input starting with unit may match, in pattern order.
+    std::span<const std::size_t> candidates(CharT unit) const noexcept {
+        auto b = std::ranges::lower_bound(buckets_, unit, {}, &_Bucket::unit);
+        return b != buckets_.end() && b->unit == unit ? std::span<const std::size_t>{ b->patterns } : std::span<const std::size_t>{ open_ };
+    }
+    std::span<const std::size_t> candidates() const noexcept { return open_; }
+
+    template <typename OtherCharT>
+    friend std::expected<basic_scan_pattern_set<OtherCharT>, std::p1729r3::scan_error>
+    compile_scan_pattern_set(std::span<const std::basic_string_view<OtherCharT>> fmts);
+private:
+    std::vector<basic_compiled_scan_pattern<CharT>>    patterns_;
+    std::vector<_Bucket>                               buckets_; // Sorted by unit, each merged with open_.
+    std::vector<std::size_t>                           open_;    // Patterns that begin with a field.
+};
+
+using  scan_pattern_set = basic_scan_pattern_set<char>;
+using wscan_pattern_set = basic_scan_pattern_set<wchar_t>;
+
+template <typename CharT>
+std::expected<basic_scan_pattern_set<CharT>, std::p1729r3::scan_error> compile_scan_pattern_set(std::span<const std::basic_string_view<CharT>> fmts) {
+    basic_scan_pattern_set<CharT> set;
+    std::vector<std::pair<CharT, std::size_t>> led;
+    for (std::size_t k = 0; k < fmts.size(); ++k) {
+        auto pat = compile_scan_pattern<CharT>(fmts[k]);
+        if (!pat.has_value()) { return std::unexpected(pat.error()); }
+
+        const _Scn_literal& lead = pat->fields().empty() ? pat->tail() : pat->fields().front().lit;
+        if (lead.count != 0) { led.emplace_back(pat->get()[lead.segments[0].begin], k); }
+        else                 { set.open_.push_back(k); }
+        set.patterns_.push_back(std::move(pat.value()));
+    }
+
+    std::ranges::stable_sort(led, {}, &std::pair<CharT, std::size_t>::first);
+    for (std::size_t i = 0; i < led.size();) {
+        typename basic_scan_pattern_set<CharT>::_Bucket b{ led[i].first, {} };
+        for (; i < led.size() && led[i].first == b.unit; ++i) { b.patterns.push_back(led[i].second); }
+        b.patterns.insert(b.patterns.end(), set.open_.begin(), set.open_.end());
+        std::ranges::sort(b.patterns);
+        set.buckets_.push_back(std::move(b));
+    }
+    return set;
+}
+
+inline std::expected<scan_pattern_set, std::p1729r3::scan_error> compile_scan_pattern_set(std::span<const std::string_view> fmts) {
+    return compile_scan_pattern_set<char>(fmts);
+}
+
+// Which pattern of a set matched and what is left of the range after it.
+template <class Rng>
+struct scan_set_match {
+    std::size_t                              index = 0;
+    std::ranges::borrowed_subrange_t<Rng>    range;
+};
+
+// Runs rg against the candidates of set until one matches, args[k] receives the fields of pattern k. When none
+// does, the error of the last candidate that failed converting a field is returned, its offset and field included.
+// If every candidate stopped on a literal, the error points at the furthest of those mismatches.
+template <class Rng, typename CharT> requires std::p1729r3::scannable_range<Rng, CharT>
+std::expected<scan_set_match<Rng>, std::p1729r3::scan_error> format_from(Rng rg, const basic_scan_pattern_set<CharT>& set,
+                                                                         std::type_identity_t<std::span<const std::p1729r3::basic_scan_args<std::p1729r3::basic_scan_context<Rng, CharT>>>> args) {
+    if (args.size() != set.size()) { return _SCAN_UNEXPECT(invalid_format_string, "Pattern set and scan_args differ in size!"); }
+    // Every pattern is checked against its args, whichever the input picks, so a mismatch shows for any line.
+    for (std::size_t k = 0; k < set.size(); ++k) {
+        if (set[k].args_required() > args[k].size()) { return _SCAN_UNEXPECT(invalid_format_string, "Pattern refers to more arguments than given!"); }
+        if (auto checked = _Check_scan_plan(set[k].fields(), args[k]); !checked) { return std::unexpected(checked.error()); }
+    }
+
+    const auto lead = _Skip_space_run(std::ranges::begin(rg), std::ranges::end(rg));
+    const auto pick = lead == std::ranges::end(rg) ? set.candidates() : set.candidates(static_cast<CharT>(*lead));
+
+    std::optional<std::p1729r3::scan_error> failed;
+    std::p1729r3::scan_error                mismatch{ std::p1729r3::scan_error::invalid_scanned_value, "Input doesn't match any pattern!" };
+    for (std::size_t k : pick) {
+        const auto& pat = set[k];
+        std::p1729r3::basic_scan_context<Rng, CharT> ctx{ rg, args[k] };
+        auto res = _Exec_scan_plan(ctx, pat.get(), pat.fields(), pat.tail());
+        if (!res.has_value())                    { failed = res.error(); }
+        else if (res.value())                    { return scan_set_match<Rng>{ k, _Scn_borrow<Rng>(ctx.range()) }; }
+        else if (res.value().offset >= mismatch.offset) {
+            mismatch.offset = res.value().offset;
+            mismatch.field  = res.value().field;
+        }
+    }
+    return std::unexpected(failed ? *failed : mismatch);
+}
+
+// Struct of arrays result of scan_lines, one column per argument type.
+template <typename ... Args>
+struct scan_columns {
+    std::tuple<std::vector<Args>...>       columns;
+    std::vector<std::size_t>               failed;    // Zero based indices of the lines the pattern didn't match.
+    std::vector<std::p1729r3::scan_error>  errors;    // Why each of them stopped, offsets count from the line start.
+    std::size_t                            lines = 0;
+
+    template <std::size_t I> auto&       column()       { return std::get<I>(columns); }
+    template <std::size_t I> const auto& column() const { return std::get<I>(columns); }
+};
+
+// Iterators over blocks of a stream, see basic_scannable_istream.
+template <class It>
+concept _Scn_blocked_iter = requires(It& i, const It& ci, std::size_t n) {
+    { ci._Ptr() }       -> std::same_as<const std::iter_value_t<It>*>;
+    { ci._Block_end() } -> std::same_as<const std::iter_value_t<It>*>;
+    i._Skip(n);
+};
+
+template <class Ty>                  constexpr bool _Scn_is_string_view                                 = false;
+template <typename CharT, class Tr> constexpr bool _Scn_is_string_view<std::basic_string_view<CharT, Tr>> = true;
+
+// scan_lines with {:L} fields reading with loc (null for the global locale) and the facet cached in np, which the
+// contexts of all lines share.
+template <typename ... Args, std::ranges::forward_range Rng>
+scan_columns<Args...> _Scan_lines(const std::locale* loc, std::p1729r3::_Scn_numpunct<_Scn_char_t<Rng>>& np, Rng&& rg,
+                                  std::p1729r3::basic_scan_format_string<_Scn_char_t<Rng>, std::type_identity_t<Args>...> fmt,
+                                  std::pmr::memory_resource* resource) {
+    using char_type    = _Scn_char_t<Rng>;
+    using line_type    = std::conditional_t<_Scn_contiguous<Rng, char_type> || _Scn_blocked_iter<std::ranges::iterator_t<Rng>>,
+                                            std::basic_string_view<char_type>, std::ranges::subrange<std::ranges::iterator_t<Rng>>>;
+    using context_type = std::p1729r3::basic_scan_context<line_type, char_type>;
+    // Lines of a stream live in blocks that are freed behind the scan, or in a buffer reused for the next line.
+    static_assert(_Scn_contiguous<Rng, char_type> || !(_Scn_is_string_view<Args> || ...),
+                  "string_view columns borrow from the input, scan_lines needs a contiguous range for them");
+
+    const std::pmr::polymorphic_allocator<> alloc{ resource };
+
+    scan_columns<Args...> out;
+    auto values = std::make_obj_using_allocator<std::tuple<Args...>>(alloc);
+    auto store  = std::apply([](auto& ... v) { return std::p1729r3::basic_scan_arg_store<context_type, Args...>{ v... }; }, values);
+    std::p1729r3::basic_scan_args<context_type> args{ store };
+
+    auto scan_line = [&](line_type line) {
+        context_type ctx{ line, args, loc, resource };
+        ctx._Share_numpunct(np);
+        auto res = _Exec_scan_plan(ctx, fmt.get(), fmt.fields(), fmt.tail());
+        if (res.has_value() && res.value()) {
+            [&]<std::size_t ... I>(std::index_sequence<I...>) {
+                (std::get<I>(out.columns).push_back(std::make_obj_using_allocator<Args>(alloc, std::get<I>(values))), ...);
+            }(std::index_sequence_for<Args...>{});
+        }
+        else {
+            out.failed.push_back(out.lines);
+            out.errors.push_back(res.has_value() ? _Scn_mismatch_error(res.value()) : res.error());
+        }
+        ++out.lines;
+    };
+
+    if constexpr (_Scn_contiguous<Rng, char_type>) {
+        line_type rest{ std::ranges::data(rg), std::ranges::size(rg) };
+        while (!rest.empty()) {
+            const auto nl = rest.find(char_type('\n'));
+            scan_line(rest.substr(0, nl));
+            rest = nl == line_type::npos ? line_type{} : rest.substr(nl + 1);
+        }
+    }
+    else if constexpr (_Scn_blocked_iter<std::ranges::iterator_t<Rng>>) {
+        // Lines inside one block are scanned in place, only a line that straddles two blocks is copied out.
+        std::basic_string<char_type> straddled;
+        auto i = std::ranges::begin(rg);
+        auto e = std::ranges::end(rg);
+        while (i != e) {
+            const char_type* p = i._Ptr();
+            const char_type* q = i._Block_end();
+            if (std::less_equal<>{}(p, e._Ptr()) && std::less_equal<>{}(e._Ptr(), q)) { q = e._Ptr(); }
+
+            if (const char_type* nl = std::find(p, q, char_type('\n')); nl != q) {
+                scan_line(line_type{ p, static_cast<std::size_t>(nl - p) });
+                i._Skip(static_cast<std::size_t>(nl - p) + 1);
+                continue;
+            }
+            straddled.clear();
+            for (; i != e && *i != char_type('\n'); ++i) { straddled.push_back(*i); }
+            if (i != e) { ++i; }
+            scan_line(line_type{ straddled });
+        }
+    }
+    else {
+        auto i = std::ranges::begin(rg);
+        auto e = std::ranges::end(rg);
+        while (i != e) {
+            auto nl = std::ranges::find(i, e, '\n');
+            scan_line(line_type{ i, nl });
+            i = nl == e ? nl : std::next(nl);
+        }
+    }
+    return out;
+}
+
+// Applies one pattern to every newline delimited record and appends each field to its own column.
+// The lowered pattern, the arg store and the numpunct facet are shared by all lines, contiguous inputs are split
+// into string_views. Allocator aware fields (pmr strings) are stored on resource, pass a monotonic_buffer_resource
+// when the whole batch is released at once.
+template <typename ... Args, std::ranges::forward_range Rng>
+scan_columns<Args...> scan_lines(Rng&& rg, std::p1729r3::basic_scan_format_string<_Scn_char_t<Rng>, std::type_identity_t<Args>...> fmt,
+                                 std::pmr::memory_resource* resource = std::pmr::get_default_resource()) {
+    std::p1729r3::_Scn_numpunct<_Scn_char_t<Rng>> np;
+    return _Scan_lines<Args...>(nullptr, np, std::forward<Rng>(rg), fmt, resource);
+}
+
+// {:L} fields read with loc, which is referenced and has to outlive the call.
+template <typename ... Args, std::ranges::forward_range Rng>
+scan_columns<Args...> scan_lines(const std::locale& loc, Rng&& rg,
+                                 std::p1729r3::basic_scan_format_string<_Scn_char_t<Rng>, std::type_identity_t<Args>...> fmt,
+                                 std::pmr::memory_resource* resource = std::pmr::get_default_resource()) {
+    std::p1729r3::_Scn_numpunct<_Scn_char_t<Rng>> np;
+    return _Scan_lines<Args...>(&loc, np, std::forward<Rng>(rg), fmt, resource);
+}
+
+// Work stealing over task indices. Every worker starts on its own slice and, once that is drained, takes the
+// upper half of the first slice it finds with work left.
+class _Index_stealer {
+    struct alignas(64) _Slice {
+        std::mutex  m;
+        std::size_t begin = 0;
+        std::size_t end   = 0;
+    };
+    std::vector<_Slice> slices_;
+public:
+    _Index_stealer(std::size_t tasks, std::size_t workers) : slices_(workers) {
+        for (std::size_t w = 0; w < workers; ++w) {
+            slices_[w].begin = tasks * w / workers;
+            slices_[w].end   = tasks * (w + 1) / workers;
+        }
+    }
+
+    std::optional<std::size_t> next(std::size_t w) {
+        auto& own = slices_[w];
+        {
+            std::lock_guard lock{ own.m };
+            if (own.begin < own.end) { return own.begin++; }
+        }
+        for (std::size_t k = 1; k < slices_.size(); ++k) {
+            auto&       victim = slices_[(w + k) % slices_.size()];
+            std::size_t b = 0, e = 0;
+            {
+                std::lock_guard lock{ victim.m };
+                if (victim.begin == victim.end) { continue; }
+                b = victim.begin + (victim.end - victim.begin) / 2;
+                e = victim.end;
+                victim.end = b;
+            }
+            std::lock_guard lock{ own.m };
+            own.begin = b + 1;
+            own.end   = e;
+            return b;
+        }
+        return std::nullopt;
+    }
+};
+
+// parallel_scan_lines with {:L} fields reading with loc, null for the global locale.
+template <typename ... Args, std::ranges::contiguous_range Rng> requires _Scn_contiguous<Rng, _Scn_char_t<Rng>>
+scan_columns<Args...> _Parallel_scan_lines(const std::locale* loc, Rng&& rg,
+                                           std::p1729r3::basic_scan_format_string<_Scn_char_t<Rng>, std::type_identity_t<Args>...> fmt,
+                                           unsigned threads) {
+    using view_type = std::basic_string_view<_Scn_char_t<Rng>>;
+
+    // The facet is looked up here once, the pieces only read it and so can share it across threads.
+    std::p1729r3::_Scn_numpunct<_Scn_char_t<Rng>> np;
+    if (std::ranges::any_of(fmt.fields(), [](const auto& op) { return op.specs.localized; })) {
+        np = std::p1729r3::_Fetch_numpunct<_Scn_char_t<Rng>>(loc);
+    }
+
+    const view_type input{ std::ranges::data(rg), std::ranges::size(rg) };
+    threads = std::max(threads, 1u);
+
+    // Several pieces per thread so stealing can even out uneven lines, but never pieces too small to be worth it.
+    const std::size_t target = std::max(input.size() / (std::size_t{ threads } * 8) + 1, std::size_t{ 1 } << 18);
+    std::vector<view_type> chunks;
+    for (std::size_t b = 0; b < input.size();) {
+        std::size_t e = b + target;
+        if (e >= input.size()) { e = input.size(); }
+        else {
+            const auto nl = input.find(_Scn_char_t<Rng>('\n'), e - 1);
+            e = nl == view_type::npos ? input.size() : nl + 1;
+        }
+        chunks.push_back(input.substr(b, e - b));
+        b = e;
+    }
+
+    std::vector<scan_columns<Args...>> parts(chunks.size());
+    const std::size_t                  workers = std::min<std::size_t>(threads, chunks.size());
+    if (workers > 1) {
+        _Index_stealer tasks{ chunks.size(), workers };
+        auto work = [&](std::size_t w) {
+            while (auto t = tasks.next(w)) { parts[*t] = _Scan_lines<Args...>(loc, np, chunks[*t], fmt, std::pmr::get_default_resource()); }
+        };
+        std::vector<std::jthread> pool;
+        for (std::size_t w = 1; w < workers; ++w) { pool.emplace_back(work, w); }
+        work(0);
+    }
+    else {
+        for (std::size_t t = 0; t < chunks.size(); ++t) { parts[t] = _Scan_lines<Args...>(loc, np, chunks[t], fmt, std::pmr::get_default_resource()); }
+    }
+
+    scan_columns<Args...> out;
+    std::size_t           rows = 0;
+    for (const auto& part : parts) { rows += part.lines - part.failed.size(); }
+    [&]<std::size_t ... I>(std::index_sequence<I...>) {
+        (std::get<I>(out.columns).reserve(rows), ...);
+        for (auto& part : parts) {
+            (std::get<I>(out.columns).insert(std::get<I>(out.columns).end(),
+                                             std::make_move_iterator(std::get<I>(part.columns).begin()),
+                                             std::make_move_iterator(std::get<I>(part.columns).end())), ...);
+            for (auto f : part.failed) { out.failed.push_back(out.lines + f); }
+            out.errors.insert(out.errors.end(), part.errors.begin(), part.errors.end());
+            out.lines += part.lines;
+        }
+    }(std::index_sequence_for<Args...>{});
+    return out;
+}
+
+// scan_lines over all cores: the input is cut into pieces at newlines, the pieces are scanned concurrently and
+// the columns and failure indices are stitched back together in the original line order.
+template <typename ... Args, std::ranges::contiguous_range Rng> requires _Scn_contiguous<Rng, _Scn_char_t<Rng>>
+scan_columns<Args...> parallel_scan_lines(Rng&& rg, std::p1729r3::basic_scan_format_string<_Scn_char_t<Rng>, std::type_identity_t<Args>...> fmt,
+                                          unsigned threads = std::thread::hardware_concurrency()) {
+    return _Parallel_scan_lines<Args...>(nullptr, std::forward<Rng>(rg), fmt, threads);
+}
+
+// {:L} fields read with loc, which is referenced and has to outlive the call.
+template <typename ... Args, std::ranges::contiguous_range Rng> requires _Scn_contiguous<Rng, _Scn_char_t<Rng>>
+scan_columns<Args...> parallel_scan_lines(const std::locale& loc, Rng&& rg,
+                                          std::p1729r3::basic_scan_format_string<_Scn_char_t<Rng>, std::type_identity_t<Args>...> fmt,
+                                          unsigned threads = std::thread::hardware_concurrency()) {
+    return _Parallel_scan_lines<Args...>(&loc, std::forward<Rng>(rg), fmt, threads);
+}
+
+// Push mode scan_lines for input that arrives in chunks of any size, e.g. socket reads. feed() hands over the next
+// chunk without copying it, next() scans the following record and yields false when the chunk ran out first.
+// Records that lie inside a chunk are scanned in place, only a record split across chunks is carried over, and
+// the next chunk completes it. Feeding before next() asked for more keeps the unread rest of the previous chunk
+// by copying it. A chunk must stay alive until next() asks for more or the following feed(), the values of a
+// record until the following next() or feed().
+template <typename CharT, typename ... Args>
+class basic_scan_feeder {
+    using view_type     = std::basic_string_view<CharT>;
+    using context_type  = std::p1729r3::basic_scan_context<view_type, CharT>;
+    using numpunct_type = std::p1729r3::_Scn_numpunct<CharT>;
+public:
+    using format_type   = std::p1729r3::basic_scan_format_string<CharT, std::type_identity_t<Args>...>;
+
+    explicit basic_scan_feeder(format_type fmt) : fmt_(fmt) {}
+
+    void feed(std::span<const CharT> chunk) {
+        carry_.append(chunk_);
+        chunk_ = view_type{ chunk.data(), chunk.size() };
+    }
+    // No more chunks follow: a last record without its newline is scanned too.
+    void finish() noexcept { finished_ = true; }
+
+    // true when values() hold the next record, false when more input is needed (or, after finish(), none is left).
+    // A record that doesn't scan is reported once and skipped, offsets in the error count from its start.
+    std::expected<bool, std::p1729r3::scan_error> next() {
+        // What is carried over comes first in the stream, whole records queued by an early feed() included.
+        view_type  line;
+        const auto rest = view_type{ carry_ }.substr(head_);
+        if (const auto nl = rest.find(CharT('\n')); nl != view_type::npos) {
+            line   = rest.substr(0, nl);
+            head_ += nl + 1;
+        }
+        else {
+            carry_.erase(0, head_);
+            head_ = 0;
+            if (const auto end = chunk_.find(CharT('\n')); end != view_type::npos) {
+                line   = chunk_.substr(0, end);
+                chunk_ = chunk_.substr(end + 1);
+                if (!carry_.empty()) { carry_.append(line); line = carry_; head_ = carry_.size(); }
+            }
+            else {
+                carry_.append(chunk_);
+                chunk_ = {};
+                if (!finished_ || carry_.empty()) { return false; }
+                line  = carry_;
+                head_ = carry_.size();
+            }
+        }
+
+        context_type ctx{ line, {} };
+        ctx._Share_numpunct(numpunct_);
+        auto res = std::apply([&](auto& ... v) { return _Exec_scan_format(ctx, fmt_, v...); }, values_);
+        ++records_;
+        if (!res.has_value()) { return std::unexpected(res.error()); }
+        if (!res.value())     { return std::unexpected(_Scn_mismatch_error(res.value())); }
+        return true;
+    }
+
+    const std::tuple<Args...>& values()  const noexcept { return values_; }
+    // Records handed out by next() so far, the failed ones included.
+    std::size_t                records() const noexcept { return records_; }
+private:
+    format_type                fmt_;
+    std::tuple<Args...>        values_{};
+    view_type                  chunk_;
+    std::basic_string<CharT>   carry_;
+    std::size_t                head_     = 0; // Where the unread part of carry_ starts.
+    std::size_t                records_  = 0;
+    bool                       finished_ = false;
+    numpunct_type              numpunct_;         // Shared by the contexts of all records.
+};
+
+template <typename ... Args> using  scan_feeder = basic_scan_feeder<char, Args...>;
+template <typename ... Args> using wscan_feeder = basic_scan_feeder<wchar_t, Args...>;
+
+// Lazy scan_lines: an input view whose elements are the newline delimited records of the underlying range, each
+// scanned when the iterator reaches it into an expected of the values. Composes with take, filter and transform,
+// nothing past the last record read is touched. The record is cached in the view and reused for the next one.
+template <std::ranges::view V, typename CharT, typename ... Args>
+class scan_each_view : public std::ranges::view_interface<scan_each_view<V, CharT, Args...>> {
+    using line_type    = std::conditional_t<_Scn_contiguous<V, CharT>,
+                                            std::basic_string_view<CharT>, std::ranges::subrange<std::ranges::iterator_t<V>>>;
+    using context_type = std::p1729r3::basic_scan_context<line_type, CharT>;
+public:
+    using format_type  = std::p1729r3::basic_scan_format_string<CharT, std::type_identity_t<Args>...>;
+    using record_type  = std::expected<std::tuple<Args...>, std::p1729r3::scan_error>;
+
+    class iterator {
+    public:
+        using iterator_concept = std::input_iterator_tag;
+        using difference_type  = std::ptrdiff_t;
+        using value_type       = record_type;
+
+        iterator() = default;
+        explicit iterator(scan_each_view* parent) noexcept : parent_(parent) {}
+        iterator(iterator&&)            = default;
+        iterator& operator=(iterator&&) = default;
+
+        const record_type& operator*() const noexcept { return parent_->record_; }
+        iterator&          operator++()                { parent_->_Read(); return *this; }
+        void               operator++(int)             { ++*this; }
+
+        bool operator==(std::default_sentinel_t) const noexcept { return parent_->done_; }
+    private:
+        scan_each_view* parent_ = nullptr;
+    };
+
+    scan_each_view() requires std::default_initializable<V> = default;
+    scan_each_view(V base, format_type fmt) : base_(std::move(base)), fmt_(fmt) {}
+
+    V base() const& requires std::copy_constructible<V> { return base_; }
+    V base() &&                                           { return std::move(base_); }
+
+    // Every begin() starts a new pass over the base range.
+    iterator                 begin() { pos_ = std::ranges::begin(base_); done_ = false; numpunct_ = {}; _Read(); return iterator{ this }; }
+    std::default_sentinel_t  end()   const noexcept { return std::default_sentinel; }
+private:
+    void _Read() {
+        const auto last = std::ranges::end(base_);
+        if (pos_ == last) { done_ = true; return; }
+
+        line_type line;
+        if constexpr (_Scn_contiguous<V, CharT>) {
+            const std::basic_string_view<CharT> rest{ std::to_address(pos_), static_cast<std::size_t>(last - pos_) };
+            const auto nl = rest.find(CharT('\n'));
+            line = rest.substr(0, nl);
+            pos_ = std::next(pos_, static_cast<std::ranges::range_difference_t<V>>(nl == rest.npos ? rest.size() : nl + 1));
+        }
+        else {
+            auto nl = std::ranges::find(pos_, last, CharT('\n'));
+            line = line_type{ pos_, nl };
+            pos_ = nl == last ? nl : std::next(nl);
+        }
+
+        // The previous record's values are scanned over, strings keep their buffers.
+        if (!record_.has_value()) { record_.emplace(); }
+        context_type ctx{ line, {} };
+        ctx._Share_numpunct(numpunct_);
+        auto res = std::apply([&](auto& ... v) { return _Exec_scan_format(ctx, fmt_, v...); }, *record_);
+        if      (!res.has_value()) { record_ = std::unexpected(res.error()); }
+        else if (!res.value())     { record_ = std::unexpected(_Scn_mismatch_error(res.value())); }
+    }
+
+    V                                  base_ = V();
+    format_type                        fmt_;
+    std::ranges::iterator_t<V>         pos_{};
+    record_type                        record_;
+    std::p1729r3::_Scn_numpunct<CharT> numpunct_;
+    bool                               done_ = false;
+};
+
+template <typename CharT, typename ... Args>
+struct _Scn_each_closure {
+    std::p1729r3::basic_scan_format_string<CharT, Args...> fmt;
+
+    template <std::ranges::viewable_range R> requires std::ranges::forward_range<R> && std::same_as<_Scn_char_t<R>, CharT>
+    friend auto operator|(R&& r, const _Scn_each_closure& c) {
+        return scan_each_view<std::views::all_t<R>, CharT, Args...>{ std::views::all(std::forward<R>(r)), c.fmt };
+    }
+};
+
+// input | scan_each<int, std::string_view, double>("{} {} {}") yields one expected<tuple> per line.
+template <typename ... Args>
+_Scn_each_closure<char, Args...> scan_each(std::p1729r3::basic_scan_format_string<char, std::type_identity_t<Args>...> fmt) { return { fmt }; }
+
+template <typename ... Args>
+_Scn_each_closure<wchar_t, Args...> scan_each(std::p1729r3::basic_scan_format_string<wchar_t, std::type_identity_t<Args>...> fmt) { return { fmt }; }
+
+#undef _SCAN_UNEXPECT
+#undef _SCAN_STATS
+#undef _SCAN_SSSE3
+#undef _SCAN_SSSE3_TARGET
+
+
+
+// Forward range over an input stream. The streambuf is read in large blocks which stay alive only while some
+// iterator still points into them, so pipes work and copies of an iterator can re-read what they have seen.
+// The range is single pass: the first begin() over it (or over any copy of it) takes the first block, later
+// ones start at the end, so nothing behind the iterators is kept and a stream of any length scans in bounded
+// memory. Nothing else should read from the stream while it is in use.
+template <typename CharT>
+class basic_scannable_istream {
+    struct _Block;
+
+    // Blocks are counted without atomics: the iterators of one stream are used from one thread, like the stream.
+    class _Ref {
+    public:
+        _Ref() = default;
+        explicit _Ref(_Block* b) noexcept : b_(b) { if (b_) { ++b_->refs; } }
+        _Ref(const _Ref& other) noexcept : _Ref(other.b_) {}
+        _Ref(_Ref&& other) noexcept : b_(std::exchange(other.b_, nullptr)) {}
+        _Ref& operator=(_Ref other) noexcept { std::swap(b_, other.b_); return *this; }
+        ~_Ref() { _Block::release(b_); }
+
+        _Block* get()        const noexcept { return b_; }
+        _Block* operator->() const noexcept { return b_; }
+        explicit operator bool() const noexcept { return b_ != nullptr; }
+        _Block* detach() noexcept { return std::exchange(b_, nullptr); }
+    private:
+        _Block* b_ = nullptr;
+    };
+
+    struct _Block {
+        std::basic_streambuf<CharT>*  sbuf     = nullptr;
+        std::size_t                   capacity = 0;
+        std::size_t                   size     = 0; // Zero only for the block past the end of the stream.
+        std::size_t                   refs     = 0;
+        std::unique_ptr<CharT[]>      data;
+        _Ref                          next;
+
+        static _Ref read(std::basic_streambuf<CharT>* sbuf, std::size_t capacity) {
+            _Ref b{ new _Block };
+            b->sbuf     = sbuf;
+            b->capacity = capacity;
+            if (sbuf) {
+                b->data = std::make_unique_for_overwrite<CharT[]>(capacity);
+                b->size = static_cast<std::size_t>(sbuf->sgetn(b->data.get(), static_cast<std::streamsize>(capacity)));
+            }
+            return b;
+        }
+        // Filled by whichever iterator gets here first.
+        _Block* following() {
+            if (!next) { next = read(size ? sbuf : nullptr, capacity); }
+            return next.get();
+        }
+        // Unlinks iteratively, a long chain pinned by an old iterator would otherwise be destroyed recursively.
+        static void release(_Block* b) noexcept {
+            while (b && --b->refs == 0) {
+                _Block* n = b->next.detach();
+                delete b;
+                b = n;
+            }
+        }
+    };
+public:
+    using char_type = CharT;
+    static constexpr std::size_t default_block_size = std::size_t{ 1 } << 16;
+
+    // Characters are served through raw pointers into the current block, the block is only counted again when
+    // the iterator is copied or crosses into the next one.
+    class iterator {
+        friend class basic_scannable_istream;
+    public:
+#ifdef __cpp_lib_concepts
+        using iterator_concept  = std::forward_iterator_tag;
+#endif // __cpp_lib_concepts
+        using iterator_category = std::forward_iterator_tag;
+        using value_type        = CharT;
+        using difference_type   = std::ptrdiff_t;
+        using pointer           = const value_type*;
+        using reference         = const value_type&;
+
+        iterator() = default;
+
+        iterator(const iterator&)            = default;
+        iterator(iterator&&)                 = default;
+        iterator& operator=(iterator&&)      = default;
+        iterator& operator=(const iterator&) = default;
+
+        reference operator*() const { return *cur_; }
+        iterator& operator++() {
+            if (++cur_ == last_) { enter_(block_->following()); }
+            return *this;
+        }
+        iterator  operator++(int) { iterator old = *this; ++*this; return old; }
+
+        // The run of the current block from here, scan_lines reads the lines inside it in place.
+        const value_type* _Ptr()       const noexcept { return cur_; }
+        const value_type* _Block_end() const noexcept { return last_; }
+        // Moves n <= _Block_end() - _Ptr() characters ahead.
+        void _Skip(std::size_t n) {
+            if ((cur_ += n) == last_) { enter_(block_->following()); }
+        }
+
+        // A default constructed iterator is the end of every stream. Only the block past the end of the stream
+        // is entered with cur_ == last_.
+        bool operator==(const iterator& other) const {
+            if (cur_ == last_ || other.cur_ == other.last_) { return (cur_ == last_) == (other.cur_ == other.last_); }
+            return cur_ == other.cur_;
+        }
+    private:
+        explicit iterator(_Ref b) { if (b) { enter_(b.get()); } }
+        void enter_(_Block* b) {
+            block_ = _Ref{ b };
+            cur_   = b->data.get();
+            last_  = cur_ + b->size;
+        }
+
+        _Ref                     block_;
+        const value_type*        cur_  = nullptr;
+        const value_type*        last_ = nullptr;
+    };
+
+    basic_scannable_istream(std::basic_istream<CharT>& strm, std::size_t block_size = default_block_size) :
+        head_(std::make_shared<_Ref>(_Block::read(strm.rdbuf(), block_size))) {}
+    // No default constructor.
+    basic_scannable_istream() = delete;
+    // Range constructor.
+    basic_scannable_istream(iterator beg, iterator end) :
+        head_(std::make_shared<_Ref>(std::move(beg.block_))), first_(beg.cur_), end_(std::move(end)) {}
+
+    iterator begin() const {
+        iterator it{ std::exchange(*head_, _Ref{}) };
+        if (!it.block_) { return end_; }
+        if (first_) { it.cur_ = first_; }
+        return it;
+    }
+    iterator end()   const { return end_; }
+
+private:
+    std::shared_ptr<_Ref>  head_;           // Shared by the copies of the range, empty once one of them began.
+    const CharT*           first_ = nullptr;
+    iterator               end_;
+};
+
+// Iterators own the blocks they read from, so scan results may outlive the range object.
+template <typename CharT>
+inline constexpr bool std::ranges::enable_borrowed_range<basic_scannable_istream<CharT>> = true;
+
+// Read only mapping of a whole file. It owns the mapping and is move only, scan it through view() which is a
+// contiguous char range, so converters run straight on the mapped pages without any copy.
+class mapped_file_range {
+public:
+    mapped_file_range() = default;
+    mapped_file_range(const mapped_file_range&)            = delete;
+    mapped_file_range& operator=(const mapped_file_range&) = delete;
+    mapped_file_range(mapped_file_range&& other) noexcept :
+        data_(std::exchange(other.data_, nullptr)), size_(std::exchange(other.size_, 0)) {}
+    mapped_file_range& operator=(mapped_file_range&& other) noexcept {
+        if (this != &other) {
+            unmap_();
+            data_ = std::exchange(other.data_, nullptr);
+            size_ = std::exchange(other.size_, 0);
+        }
+        return *this;
+    }
+    ~mapped_file_range() { unmap_(); }
+
+    static std::expected<mapped_file_range, std::error_code> open(const std::filesystem::path& path) {
+        mapped_file_range file;
+#ifdef _WIN32
+        HANDLE fh = ::CreateFileW(path.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING,
+                                  FILE_ATTRIBUTE_NORMAL | FILE_FLAG_SEQUENTIAL_SCAN, nullptr);
+        if (fh == INVALID_HANDLE_VALUE) { return std::unexpected(std::error_code(::GetLastError(), std::system_category())); }
+        LARGE_INTEGER size;
+        if (!::GetFileSizeEx(fh, &size)) {
+            auto ec = std::error_code(::GetLastError(), std::system_category());
+            ::CloseHandle(fh);
+            return std::unexpected(ec);
+        }
+        if (size.QuadPart == 0) { ::CloseHandle(fh); return file; }
+
+        HANDLE mh = ::CreateFileMappingW(fh, nullptr, PAGE_READONLY, 0, 0, nullptr);
+        void*  p  = mh ? ::MapViewOfFile(mh, FILE_MAP_READ, 0, 0, 0) : nullptr;
+        auto   ec = std::error_code(p ? 0 : ::GetLastError(), std::system_category());
+        if (mh) { ::CloseHandle(mh); }
+        ::CloseHandle(fh);
+        if (!p) { return std::unexpected(ec); }
+
+        file.data_ = static_cast<const char*>(p);
+        file.size_ = static_cast<std::size_t>(size.QuadPart);
+#else
+        int fd = ::open(path.c_str(), O_RDONLY | O_CLOEXEC);
+        if (fd < 0) { return std::unexpected(std::error_code(errno, std::system_category())); }
+        struct stat st;
+        if (::fstat(fd, &st) != 0) {
+            auto ec = std::error_code(errno, std::system_category());
+            ::close(fd);
+            return std::unexpected(ec);
+        }
+        // mmap refuses empty lengths, an empty file is an empty range.
+        if (st.st_size == 0) { ::close(fd); return file; }
+
+        const auto size = static_cast<std::size_t>(st.st_size);
+        void*      p    = map_aligned_(fd, size);
+        auto       ec   = std::error_code(p == MAP_FAILED ? errno : 0, std::system_category());
+        ::close(fd);
+        if (p == MAP_FAILED) { return std::unexpected(ec); }
+
+        // Hints only, failures are harmless.
+        ::posix_madvise(p, size, POSIX_MADV_SEQUENTIAL);
+#ifdef MADV_HUGEPAGE
+        ::madvise(p, size, MADV_HUGEPAGE);
+#endif
+        file.data_ = static_cast<const char*>(p);
+        file.size_ = size;
+#endif
+        return file;
+    }
+
+    const char*      begin() const noexcept { return data_; }
+    const char*      end()   const noexcept { return data_ + size_; }
+    const char*      data()  const noexcept { return data_; }
+    std::size_t      size()  const noexcept { return size_; }
+    bool             empty() const noexcept { return size_ == 0; }
+    std::string_view view()  const noexcept { return { data_, size_ }; }
+
+private:
+#ifndef _WIN32
+    // Large files are placed on a 2 MiB boundary so the kernel can back them with huge pages.
+    static void* map_aligned_(int fd, std::size_t size) {
+        constexpr std::size_t huge = std::size_t{ 1 } << 21;
+        if (size < huge) { return ::mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0); }
+
+        const auto page    = static_cast<std::size_t>(::sysconf(_SC_PAGESIZE));
+        const auto length  = (size + page - 1) & ~(page - 1);
+        void*      reserve = ::mmap(nullptr, length + huge, PROT_NONE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+        if (reserve == MAP_FAILED) { return ::mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0); }
+
+        const auto base    = reinterpret_cast<std::uintptr_t>(reserve);
+        const auto aligned = (base + huge - 1) & ~(huge - 1);
+        void*      p       = ::mmap(reinterpret_cast<void*>(aligned), size, PROT_READ, MAP_PRIVATE | MAP_FIXED, fd, 0);
+        if (p == MAP_FAILED) { ::munmap(reserve, length + huge); return p; }
+        // Give the unused ends of the reservation back.
+        if (aligned > base) { ::munmap(reserve, aligned - base); }
+        if (base + huge > aligned) { ::munmap(reinterpret_cast<void*>(aligned + length), base + huge - aligned); }
+        return p;
+    }
+#endif
+    void unmap_() noexcept {
+        if (!data_) { return; }
+#ifdef _WIN32
+        ::UnmapViewOfFile(data_);
+#else
+        ::munmap(const_cast<char*>(data_), size_);
+#endif
+        data_ = nullptr;
+        size_ = 0;
+    }
+
+    const char* data_ = nullptr;
+    std::size_t size_ = 0;
+};
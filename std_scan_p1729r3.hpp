@@ -15,6 +15,8 @@
 #include <array>
 #include <expected>
 #include <format>
+#include <locale>
+#include <memory_resource>
 #include <ranges>
 STD_BEGIN
 namespace p1729r3 {
@@ -26,7 +28,7 @@ namespace p1729r3 {
         _Unsigned_i8, _Unsigned_i16, _Unsigned_i32, _Unsigned_i64,  _Unsigned_long,
         _Float32,     _Float64,      _Float_ext,
         _Bool,        _Void_ptr,     _C_string,
-        _Std_string,  _Custom
+        _Std_string,  _Std_string_view, _Pmr_string,  _Custom
     };
     struct scan_error;
     // It's just a wrap which contains noting but a type alias.
@@ -36,12 +38,15 @@ namespace p1729r3 {
     template <class Context>                                    class basic_scan_arg;
     template <class Context>                                    class basic_scan_args;
     template <RANGES forward_range Rng, typename CharT>         class basic_scan_context;
+    template <typename CharT, typename ... Args>                class basic_scan_format_string;
 
     template<class CharT> using basic_scan_parse_context = basic_format_parse_context<CharT>;
     using                             scan_parse_context = basic_scan_parse_context<char>;
     using                            wscan_parse_context = basic_scan_parse_context<wchar_t>;
     template <class Rng>  using             scan_context = basic_scan_context<Rng, char>;
     template <class Rng>  using            wscan_context = basic_scan_context<Rng, wchar_t>;
+    template <class... Args> using    scan_format_string = basic_scan_format_string<char, type_identity_t<Args>...>;
+    template <class... Args> using   wscan_format_string = basic_scan_format_string<wchar_t, type_identity_t<Args>...>;
 
     template<class T, class Context,
         class Scanner = typename Context::template scanner_type<remove_const_t<T>>>
@@ -77,7 +82,7 @@ namespace p1729r3 {
         // See if ptr == nullptr that means you have passed in a discard type and scanner won't write
         // Value into that discard type (discard types also contains nothing).
         template <typename Context> requires std::is_same_v<typename Context::char_type, CharT>
-        basic_scanner_result_type<Context> scan(Ty* ptr, basic_scan_context<typename Context::range_type, CharT>& ctx);
+        basic_scanner_result_type<Context> scan(Ty* ptr, Context& ctx);
 
         ~scanner() = default;
     };
@@ -101,6 +106,8 @@ namespace p1729r3 {
 
         code_type        code;
         STD string_view  msg;
+        size_t           offset = 0; // Code units of input consumed before the failing field or literal.
+        size_t           field  = 0; // Replacement field it failed in, in pattern order.
 
         constexpr operator bool() const { return good == code; }
     };
@@ -142,11 +149,11 @@ namespace p1729r3 {
         constexpr iterator end() const   { return range_.end(); }
 
         template<class Self>
-        constexpr auto&& values(this Self&&) { return values_; }
+        constexpr auto&& values(this Self&& self) { return STD forward<Self>(self).values_; }
 
         template<class Self>
         requires (sizeof...(Args) == 1)
-        constexpr auto&& value(this Self&&) { return STD get<0>(values_); }
+        constexpr auto&& value(this Self&& self) { return STD get<0>(STD forward<Self>(self).values_); }
     private:
         range_type     range_;
         tuple<Args...> values_; 
@@ -178,6 +185,8 @@ namespace p1729r3 {
             double*                      _Float64;
             long double*                 _Float_ext;
             STD basic_string<char_type>* _Std_string;
+            STD basic_string_view<char_type>* _Std_string_view;
+            STD pmr::basic_string<char_type>* _Pmr_string;
             handle                       _Custom;
         };
 
@@ -230,6 +239,8 @@ namespace p1729r3 {
         constexpr explicit basic_scan_arg(char_type** v) noexcept                  : type_(_Scn_arg_type::_C_string)      {value_._C_string = v;}
         constexpr explicit basic_scan_arg(void** v) noexcept                       : type_(_Scn_arg_type::_Void_ptr)      {value_._Void_ptr = v;}
         constexpr explicit basic_scan_arg(STD basic_string<char_type>* v) noexcept : type_(_Scn_arg_type::_Std_string)    {value_._Std_string = v;}
+        constexpr explicit basic_scan_arg(STD basic_string_view<char_type>* v) noexcept : type_(_Scn_arg_type::_Std_string_view) {value_._Std_string_view = v;}
+        constexpr explicit basic_scan_arg(STD pmr::basic_string<char_type>* v) noexcept : type_(_Scn_arg_type::_Pmr_string) {value_._Pmr_string = v;}
 
         constexpr explicit basic_scan_arg(scan_skip            <signed char>*)  : basic_scan_arg(scan_skip<signed char>::value) {}
         constexpr explicit basic_scan_arg(scan_skip                  <short>*)  : basic_scan_arg(scan_skip<short>::value) {}
@@ -248,6 +259,8 @@ namespace p1729r3 {
         constexpr explicit basic_scan_arg(scan_skip             <char_type*>*)  : basic_scan_arg(scan_skip<char_type*>::value) {}
         constexpr explicit basic_scan_arg(scan_skip                  <void*>*)  : basic_scan_arg(scan_skip<void*>::value) {}
         constexpr explicit basic_scan_arg(scan_skip<basic_string<char_type>>*)  : basic_scan_arg(scan_skip<basic_string<char_type>>::value) {}
+        constexpr explicit basic_scan_arg(scan_skip<basic_string_view<char_type>>*) : basic_scan_arg(scan_skip<basic_string_view<char_type>>::value) {}
+        constexpr explicit basic_scan_arg(scan_skip<pmr::basic_string<char_type>>*) : basic_scan_arg(scan_skip<pmr::basic_string<char_type>>::value) {}
 
         // Handle accepts both writable values and ignored values.
         constexpr basic_scan_arg(handle v) noexcept : type_(_Scn_arg_type::_Custom) { value_._Custom = v; }
@@ -255,6 +268,7 @@ namespace p1729r3 {
         explicit operator bool() const noexcept {
             return type_ != _Scn_arg_type::_None;
         }
+        constexpr _Scn_arg_type type() const noexcept { return type_; }
         // Visit member function can be used to replace visit_scan_arg.
         template <typename Visitor>
         decltype(auto) visit(Visitor&& vis) {
@@ -277,6 +291,8 @@ namespace p1729r3 {
             case _Scn_arg_type::_Void_ptr:       return STD forward<Visitor>(vis)(value_._Void_ptr);      
             case _Scn_arg_type::_C_string:       return STD forward<Visitor>(vis)(value_._C_string);      
             case _Scn_arg_type::_Std_string:     return STD forward<Visitor>(vis)(value_._Std_string);    
+            case _Scn_arg_type::_Std_string_view:return STD forward<Visitor>(vis)(value_._Std_string_view);
+            case _Scn_arg_type::_Pmr_string:     return STD forward<Visitor>(vis)(value_._Pmr_string);
             case _Scn_arg_type::_Custom:         return STD forward<Visitor>(vis)(value_._Custom);        
             }
         }
@@ -305,6 +321,8 @@ namespace p1729r3 {
     DECL_ARG_PTR_CAST(double);
     DECL_ARG_PTR_CAST(long double);
     DECL_ARG_PTR_CAST(basic_string<typename Context::char_type>);
+    DECL_ARG_PTR_CAST(basic_string_view<typename Context::char_type>);
+    DECL_ARG_PTR_CAST(pmr::basic_string<typename Context::char_type>);
     DECL_ARG_PTR_CAST(scan_skip<signed char>);
     DECL_ARG_PTR_CAST(scan_skip<short>);
     DECL_ARG_PTR_CAST(scan_skip<int>);
@@ -322,9 +340,19 @@ namespace p1729r3 {
     DECL_ARG_PTR_CAST(scan_skip<double>);
     DECL_ARG_PTR_CAST(scan_skip<long double>);
     DECL_ARG_PTR_CAST(scan_skip<basic_string<typename Context::char_type>>);
+    DECL_ARG_PTR_CAST(scan_skip<basic_string_view<typename Context::char_type>>);
+    DECL_ARG_PTR_CAST(scan_skip<pmr::basic_string<typename Context::char_type>>);
 
 #undef DECL_ARG_PTR_CAST
 
+    // Slot a type occupies in basic_scan_arg, computed without an object so patterns can be checked at compile time.
+    template <typename Ty, class Context>
+    inline constexpr _Scn_arg_type _Scn_arg_type_of = [] {
+        using pointer = decltype(_Arg_ptr_cast<Ty, Context>{}(STD declval<Ty&>()));
+        if constexpr (STD is_pointer_v<pointer>) { return basic_scan_arg<Context>{ pointer{} }.type(); }
+        else                                     { return _Scn_arg_type::_Custom; }
+    }();
+
     template <class Context, typename ... Args>
     class basic_scan_arg_store {
     public:
@@ -345,9 +373,10 @@ namespace p1729r3 {
         basic_scan_args(const basic_scan_arg_store<Context, Args...>& store) noexcept :
         size_(sizeof ... (Args)), data_(&(store.data[0])) {}
 
-        basic_scan_arg<Context> get(size_t id) const {
+        // Ids past the end give an empty arg, scanning into it is reported as a scan_error.
+        basic_scan_arg<Context> get(size_t id) const noexcept {
             if (id >= size_) {
-                throw STD out_of_range("scan arg index out of range!");
+                return basic_scan_arg<Context>{};
             }
             return *(data_ + id);
         }
@@ -356,11 +385,39 @@ namespace p1729r3 {
         }
     };
 
+    // Separators of a numpunct facet as the code units {:L} fields compare against.
+    template <typename CharT>
+    struct _Scn_numpunct {
+        bool   ready     = false;
+        bool   plain     = true;  // '.' and no grouping, numbers read exactly like without L.
+        bool   grouped   = false;
+        CharT  decimal   = CharT('.');
+        CharT  thousands = CharT(',');
+    };
+
+    // Looks the facet up in loc, or in the global locale when loc is null. Code units without a numpunct of their
+    // own use the char one.
+    template <typename CharT>
+    _Scn_numpunct<CharT> _Fetch_numpunct(const STD locale* loc) {
+        using facet_char = conditional_t<is_same_v<CharT, wchar_t>, wchar_t, char>;
+        auto fetch = [](const STD locale& l) {
+            const auto&          np = STD use_facet<STD numpunct<facet_char>>(l);
+            _Scn_numpunct<CharT> out;
+            out.decimal   = static_cast<CharT>(np.decimal_point());
+            out.thousands = static_cast<CharT>(np.thousands_sep());
+            out.grouped   = !np.grouping().empty();
+            out.plain     = out.decimal == CharT('.') && !out.grouped;
+            out.ready     = true;
+            return out;
+        };
+        return loc ? fetch(*loc) : fetch(STD locale{});
+    }
+
     template <RANGES forward_range Rng, typename CharT>
     class basic_scan_context {
     public:
         using char_type        = CharT;
-        using range_type       = Rng;
+        using range_type       = remove_cvref_t<Rng>;
         using iterator         = RANGES iterator_t<range_type>;
         using sentinel         = RANGES sentinel_t<range_type>;
         template <typename Ty>
@@ -368,19 +425,42 @@ namespace p1729r3 {
 
         constexpr basic_scan_context(Rng rg, basic_scan_args<basic_scan_context> args):
             current_(rg.begin()), end_(rg.end()), args_(args) {}
-        constexpr basic_scan_context(Rng rg, basic_scan_args<basic_scan_context> args, const std::locale& loc) :
-            current_(rg.begin()), end_(rg.end()), locale_(loc), args_(args) {}
+        // loc is referenced, not copied, and has to outlive the context.
+        constexpr basic_scan_context(Rng rg, basic_scan_args<basic_scan_context> args, const STD locale& loc) :
+            current_(rg.begin()), end_(rg.end()), locale_(&loc), args_(args) {}
+        basic_scan_context(Rng rg, basic_scan_args<basic_scan_context> args, const STD locale&& loc) = delete;
+        // Values the scan creates itself (e.g. strings in a scan_result) allocate from resource.
+        constexpr basic_scan_context(Rng rg, basic_scan_args<basic_scan_context> args, pmr::memory_resource* resource) :
+            current_(rg.begin()), end_(rg.end()), resource_(resource), args_(args) {}
+        // Takes the locale and resource of another context, loc may be null.
+        constexpr basic_scan_context(Rng rg, basic_scan_args<basic_scan_context> args, const STD locale* loc, pmr::memory_resource* resource) :
+            current_(rg.begin()), end_(rg.end()), locale_(loc), resource_(resource), args_(args) {}
 
         constexpr basic_scan_arg<basic_scan_context> arg(size_t id) const noexcept { return args_.get(id); }
-        STD locale                                   locale() { return locale_; }
+        // Only {:L} fields ask for it, a context without a locale of its own hands out the global one then.
+        STD locale                                   locale() const { return locale_ ? *locale_ : STD locale{}; }
+        const STD locale*                            _Locale_ptr() const noexcept { return locale_; }
+        // The facet is looked up by the first {:L} field and kept for the rest of the scan, in the cache handed to
+        // _Share_numpunct if there is one so that a batch of contexts over the same locale looks it up only once.
+        const _Scn_numpunct<CharT>& _Numpunct() const {
+            auto& np = shared_numpunct_ ? *shared_numpunct_ : numpunct_;
+            if (!np.ready) { np = _Fetch_numpunct<CharT>(locale_); }
+            return np;
+        }
+        // np has to outlive the context and belong to contexts over the same locale only.
+        constexpr void                               _Share_numpunct(_Scn_numpunct<CharT>& np) noexcept { shared_numpunct_ = &np; }
+        pmr::memory_resource*                        resource() const noexcept { return resource_; }
         constexpr iterator                           current() const { return current_; }
-        constexpr range_type                         range()   const { return range_type{ current_, end_ }; }
+        constexpr RANGES subrange<iterator, sentinel> range()  const { return { current_, end_ }; }
         constexpr void                               advance_to(iterator it) { current_ = it; }
     private:
         iterator                            current_;
         sentinel                            end_;
-        STD locale                          locale_;
+        const STD locale*                   locale_   = nullptr;
+        pmr::memory_resource*               resource_ = pmr::get_default_resource();
         basic_scan_args<basic_scan_context> args_;
+        mutable _Scn_numpunct<CharT>        numpunct_;
+        _Scn_numpunct<CharT>*               shared_numpunct_ = nullptr;
     };
 
     template<scannable_range<char> Rng>
@@ -396,28 +476,35 @@ namespace p1729r3 {
     vscan_result_type<Rng> vscan(const locale& loc, Rng&& range, wstring_view fmt, wscan_args<Rng> args);
 
     template<class... Args, scannable_range<char> Rng>
-    scan_result_type<Rng, Args...> scan(Rng&& range, STD string_view fmt);
+    scan_result_type<Rng, Args...> scan(Rng&& range, scan_format_string<Args...> fmt);
 
     template<class... Args, scannable_range<wchar_t> Rng>
-    scan_result_type<Rng, Args...> scan(Rng&& range, STD wstring_view fmt);
+    scan_result_type<Rng, Args...> scan(Rng&& range, wscan_format_string<Args...> fmt);
 
     template<class... Args, scannable_range<char> Rng>
-    scan_result_type<Rng, Args...> scan(const locale& loc, Rng&& range, STD string_view fmt);
+    scan_result_type<Rng, Args...> scan(const locale& loc, Rng&& range, scan_format_string<Args...> fmt);
 
     template <class... Args, scannable_range<wchar_t> Rng>
-    scan_result_type<Rng, Args...> scan(const locale& loc, Rng&& range, STD wstring_view fmt);
+    scan_result_type<Rng, Args...> scan(const locale& loc, Rng&& range, wscan_format_string<Args...> fmt);
+
+    // Allocator aware values in the result (pmr strings) are constructed on resource.
+    template<class... Args, scannable_range<char> Rng>
+    scan_result_type<Rng, Args...> scan(pmr::memory_resource* resource, Rng&& range, scan_format_string<Args...> fmt);
+
+    template<class... Args, scannable_range<wchar_t> Rng>
+    scan_result_type<Rng, Args...> scan(pmr::memory_resource* resource, Rng&& range, wscan_format_string<Args...> fmt);
 
     template<class ... Args, scannable_range<char> Rng>
-    scan_from_result_type<Rng> scan_from(Rng&& range, string_view fmt, Args& ... args);
+    scan_from_result_type<Rng> scan_from(Rng&& range, scan_format_string<Args...> fmt, Args& ... args);
 
     template<class ... Args, scannable_range<wchar_t> Rng>
-    scan_from_result_type<Rng> scan_from(Rng&& range, wstring_view fmt, Args& ... args);
+    scan_from_result_type<Rng> scan_from(Rng&& range, wscan_format_string<Args...> fmt, Args& ... args);
 
     template<class ... Args, scannable_range<char> Rng>
-    scan_from_result_type<Rng> scan_from(const locale& loc, Rng&& range, string_view fmt, Args& ... args);
+    scan_from_result_type<Rng> scan_from(const locale& loc, Rng&& range, scan_format_string<Args...> fmt, Args& ... args);
 
     template<class ... Args, scannable_range<wchar_t> Rng>
-    scan_from_result_type<Rng> scan_from(const locale& loc, Rng&& range, wstring_view fmt, Args& ... args);
+    scan_from_result_type<Rng> scan_from(const locale& loc, Rng&& range, wscan_format_string<Args...> fmt, Args& ... args);
 
 
     template <class Rng, class ... Args>
@@ -425,7 +512,7 @@ namespace p1729r3 {
         return basic_scan_arg_store<scan_context<Rng>, Args ...> { args... };
     }
     template<class Rng, class... Args>
-    constexpr basic_scan_args<scan_context<Rng>> make_scan_args(basic_scan_arg_store<scan_context<Rng>,Args...> ast) {
+    constexpr basic_scan_args<scan_context<Rng>> make_scan_args(const basic_scan_arg_store<scan_context<Rng>,Args...>& ast) {
         return basic_scan_args<scan_context<Rng>>{ast};
     }
     template <class Rng, class ... Args>
@@ -433,7 +520,7 @@ namespace p1729r3 {
         return basic_scan_arg_store<wscan_context<Rng>, Args ...> { args... };
     }
     template<class Rng, class... Args>
-    constexpr basic_scan_args<wscan_context<Rng>> make_wscan_args(basic_scan_arg_store<wscan_context<Rng>, Args...> ast) {
+    constexpr basic_scan_args<wscan_context<Rng>> make_wscan_args(const basic_scan_arg_store<wscan_context<Rng>, Args...>& ast) {
         return basic_scan_args<wscan_context<Rng>>{ast};
     }
     template<class Rng, class Context, class... Args>
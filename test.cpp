@@ -0,0 +1,372 @@
+// Checks of the scanning engine: plan lowering and what it rejects at compile time, integer and float fields
+// against std::from_chars, the vector kernels against scalar loops, and scan_lines against the other drivers.
+//
+//     g++ -std=c++23 -O2 test.cpp -o test && ./test
+//     g++ -std=c++23 -O2 -march=native test.cpp -o test && ./test
+//
+// Run both builds: the first takes the SSE2 loops and the SSSE3 kernels picked by cpuid, the second the AVX2 loops.
+// Every failed check is printed, the exit status is the number of failures (capped at 255).
+#include <charconv>
+#include <cstdio>
+#include <list>
+#include <random>
+#include <source_location>
+#include <sstream>
+
+#include "format_from.hpp"
+
+namespace {
+
+namespace scn = std::p1729r3;
+
+int failures = 0;
+
+void expect(bool ok, std::string_view what, std::source_location at = std::source_location::current()) {
+    if (ok) { return; }
+    ++failures;
+    std::printf("test.cpp:%u: %.*s\n", static_cast<unsigned>(at.line()), static_cast<int>(what.size()), what.data());
+}
+
+// Lowering. The plan of a pattern is built in constant evaluation, so most of it is checked by static_assert.
+constexpr scn::basic_scan_format_string<char, int, std::string, double> plan{ "id={} name={:[a-z]} v={:e};" };
+static_assert(plan.fields().size() == 3);
+static_assert(plan.sequential());
+static_assert(plan.fields()[0].type == scn::_Scn_arg_type::_Signed_i32);
+static_assert(plan.fields()[1].type == scn::_Scn_arg_type::_Std_string && plan.fields()[1].specs.type == '[');
+static_assert(plan.fields()[1].specs.charset.test('q') && !plan.fields()[1].specs.charset.test('Q'));
+static_assert(plan.fields()[2].arg_id == 2 && plan.fields()[2].specs.type == 'e');
+static_assert(plan.fields()[0].lit.begin == 0 && plan.fields()[0].lit.end == 3);
+static_assert(plan.tail().begin == plan.get().size() - 1 && plan.tail().end == plan.get().size());
+
+constexpr scn::basic_scan_format_string<char, int, int> swapped{ "{1}:{0}" };
+static_assert(!swapped.sequential() && swapped.fields()[0].arg_id == 1 && swapped.fields()[1].arg_id == 0);
+
+constexpr scn::basic_scan_format_string<char, int> escaped{ "{{{}}}" };
+static_assert(escaped.fields().size() == 1 && escaped.fields()[0].lit.end == 2 && escaped.tail().begin == 4);
+
+// Patterns the constructor refuses, the same verdicts _Validate returns. Ids past the arguments and presentation
+// types are checked against the arguments, which runtime patterns only learn when they are scanned.
+struct rejection {
+    std::string_view pattern;
+    std::string_view msg;
+    bool             runtime;  // compile_scan_pattern refuses it too.
+};
+
+constexpr rejection rejections[] = {
+    { "{} {} {}",  "Argument id out of range!",                                false },
+    { "{2}",       "Argument id out of range!",                                false },
+    { "{0} {0}",   "Argument is scanned more than once!",                      true  },
+    { "{0} {}",    "Cannot switch from manual to automatic argument indexing!", true  },
+    { "{} {1}",    "Cannot switch from automatic to manual argument indexing!", true  },
+    { "{",         "Unterminated replacement field!",                          true  },
+    { "a}b",       "Invalid escape code }",                                    true  },
+    { "{:}",       "Scan description is empty!",                               true  },
+    { "{a}",       "Invalid character in replacment field",                    true  },
+    { "{:x} {}",   "Presentation type doesn't fit the argument!",              false },
+    { "{} {:[0]}", "Presentation type doesn't fit the argument!",              false },
+};
+
+using double_int = scn::basic_scan_format_string<char, double, int>;
+
+consteval bool all_rejected() {
+    for (const auto& r : rejections) {
+        if (double_int::_Validate(r.pattern).msg != r.msg) { return false; }
+    }
+    return double_int::_Validate("{:a} {:x}") && double_int::_Validate("{1} {0}");
+}
+static_assert(all_rejected());
+
+void test_runtime_lowering() {
+    for (const auto& r : rejections) {
+        auto pat = compile_scan_pattern(r.pattern);
+        if (r.runtime) { expect(!pat && pat.error().msg == r.msg, r.pattern); }
+        else           { expect(pat.has_value(), r.pattern); }
+    }
+
+    // Runtime patterns check presentation types once the arguments are known.
+    double d = 0;
+    int    i = 0;
+    auto   store = scn::make_scan_arg_store<std::string_view>(d, i);
+    auto   pat   = compile_scan_pattern("{:x} {}");
+    auto   res   = format_from(std::string_view{ "1 2" }, *pat, scn::make_scan_args(store));
+    expect(!res && res.error().msg == "Presentation type doesn't fit the argument!", "runtime presentation check");
+}
+
+// Integers. Without a sign, a base prefix or a '+', every field must read exactly what from_chars reads.
+template <typename Ty, unsigned Base, class Rng>
+auto scan_integer(Rng rg, Ty& v) {
+    if constexpr (Base == 16)     { return format_from(rg, "{:x}", v); }
+    else if constexpr (Base == 8) { return format_from(rg, "{:o}", v); }
+    else if constexpr (Base == 2) { return format_from(rg, "{:b}", v); }
+    else                          { return format_from(rg, "{}", v); }
+}
+
+std::string random_integer_text(std::mt19937_64& g, unsigned base) {
+    // 'b' would make "0b" a binary prefix, 'x' never shows up.
+    const std::string_view digits = base == 2 ? "0123456789" : "0123456789abcdefABCDEF";
+    std::string            s;
+    if (g() % 4 == 0) { s += '-'; }
+    if (g() % 4 == 0) { s += "000"; }
+    for (auto n = g() % 26; n != 0; --n) { s += digits[g() % digits.size()]; }
+    s += ";,."[g() % 3];
+    return s;
+}
+
+template <typename Ty, unsigned Base>
+void test_integer_parity(std::mt19937_64& g, int rounds) {
+    for (int k = 0; k < rounds; ++k) {
+        const std::string text = random_integer_text(g, Base);
+        const char*       name = text.c_str();
+
+        Ty   want = 0;
+        auto ref  = std::from_chars(text.data(), text.data() + text.size(), want, static_cast<int>(Base));
+
+        Ty   got = 0;
+        auto res = scan_integer<Ty, Base>(std::string_view{ text }, got);
+        if (ref.ec == std::errc{}) {
+            expect(res && got == want && res->begin() - text.data() == ref.ptr - text.data(), name);
+        }
+        else {
+            const auto code = ref.ec == std::errc::result_out_of_range ? scn::scan_error::value_out_of_range
+                                                                        : scn::scan_error::invalid_scanned_value;
+            expect(!res && res.error().code == code, name);
+        }
+
+        // The iterator path agrees with the in place one.
+        std::list<char> list(text.begin(), text.end());
+        Ty   slow = 0;
+        auto lres = scan_integer<Ty, Base>(std::ranges::subrange(list), slow);
+        expect(lres.has_value() == res.has_value() && (!lres || (slow == got &&
+               std::ranges::distance(list.begin(), lres->begin()) == res->begin() - text.data())), name);
+
+        // A leading '+' changes nothing.
+        if (text[0] != '-') {
+            const std::string plus = "+" + text;
+            Ty   signed_got = 0;
+            auto pres       = scan_integer<Ty, Base>(std::string_view{ plus }, signed_got);
+            expect(pres.has_value() == res.has_value() && (!pres || signed_got == got), plus);
+        }
+    }
+}
+
+template <typename Ty>
+void test_integers(std::mt19937_64& g) {
+    test_integer_parity<Ty, 10>(g, 4000);
+    test_integer_parity<Ty, 16>(g, 2000);
+    test_integer_parity<Ty, 8>(g, 2000);
+    test_integer_parity<Ty, 2>(g, 2000);
+}
+
+// Floats, checked like the integers. Values are printed in every format to_chars has, plus random text.
+template <typename Ty>
+std::string random_float_text(std::mt19937_64& g, char& type) {
+    constexpr std::string_view specials[] = { "inf", "-inf", "nan", "infinity", "1e400", "1e-400", "-0", ".5", "5.", "." };
+    const std::string_view     alphabet   = "0123456789.eE+-";
+
+    char buf[64];
+    type = '\0';
+    switch (g() % 6) {
+    case 0: return std::string{ specials[g() % std::size(specials)] } + ";";
+    case 1: {
+        std::string s;
+        for (auto n = 1 + g() % 20; n != 0; --n) { s += alphabet[g() % alphabet.size()]; }
+        // A leading '+' is accepted where from_chars refuses it.
+        const auto sign = s.find_first_not_of('+');
+        return (sign == std::string::npos ? std::string{} : s.substr(sign)) + ";";
+    }
+    default: break;
+    }
+
+    const Ty v = static_cast<Ty>(std::ldexp(static_cast<double>(g() >> 11), static_cast<int>(g() % 200) - 150) * (g() % 2 ? 1 : -1));
+    switch (g() % 4) {
+    case 0:  return { buf, std::to_chars(buf, buf + sizeof(buf), v).ptr };
+    case 1:  return { buf, std::to_chars(buf, buf + sizeof(buf), v, std::chars_format::scientific).ptr };
+    case 2:  return { buf, std::to_chars(buf, buf + sizeof(buf), v, std::chars_format::general, 5).ptr };
+    default: type = 'a'; return { buf, std::to_chars(buf, buf + sizeof(buf), v, std::chars_format::hex).ptr };
+    }
+}
+
+template <typename Ty>
+void test_float_parity(std::mt19937_64& g, int rounds) {
+    for (int k = 0; k < rounds; ++k) {
+        char              type = '\0';
+        const std::string text = random_float_text<Ty>(g, type);
+        const char*       name = text.c_str();
+
+        Ty   want = 0;
+        auto ref  = std::from_chars(text.data(), text.data() + text.size(), want,
+                                    type == 'a' ? std::chars_format::hex : std::chars_format::general);
+        Ty   got  = 0;
+        auto res  = type == 'a' ? format_from(std::string_view{ text }, "{:a}", got) : format_from(std::string_view{ text }, "{}", got);
+        if (ref.ec == std::errc{}) {
+            const bool same = std::isnan(want) ? std::isnan(got) : std::bit_cast<std::array<char, sizeof(Ty)>>(got) ==
+                                                                    std::bit_cast<std::array<char, sizeof(Ty)>>(want);
+            expect(res && same && res->begin() - text.data() == ref.ptr - text.data(), name);
+        }
+        else {
+            const auto code = ref.ec == std::errc::result_out_of_range ? scn::scan_error::value_out_of_range
+                                                                        : scn::scan_error::invalid_scanned_value;
+            expect(!res && res.error().code == code, name);
+        }
+
+        std::list<char> list(text.begin(), text.end());
+        Ty   slow = 0;
+        auto lres = type == 'a' ? format_from(std::ranges::subrange(list), "{:a}", slow) : format_from(std::ranges::subrange(list), "{}", slow);
+        expect(lres.has_value() == res.has_value() && (!lres || std::isnan(got) || slow == got), name);
+    }
+}
+
+// Kernels. Random bytes at every alignment, long enough to cross the vector loops into their scalar tails.
+std::string random_bytes(std::mt19937_64& g, std::string_view common) {
+    std::string s(g() % 130, '\0');
+    for (auto& c : s) { c = g() % 4 == 0 ? static_cast<char>(g()) : common[g() % common.size()]; }
+    return s;
+}
+
+template <unsigned Base>
+void test_digit_kernels(const std::string& s) {
+    const char* first = s.data();
+    const char* last  = first + s.size();
+    std::size_t want  = 0;
+    while (want < s.size() && _Scn_digit(static_cast<unsigned char>(s[want])) < Base) { ++want; }
+    expect(_Digit_run<Base>(first, last) == want, "_Digit_run");
+
+    const std::size_t n = std::min<std::size_t>(want, Base == 10 ? 19 : Base == 16 ? 15 : Base == 8 ? 21 : 63);
+    std::uint64_t     v = 0;
+    for (std::size_t i = 0; i < n; ++i) { v = v * Base + _Scn_digit(static_cast<unsigned char>(s[i])); }
+    expect(_Digits_value<Base>(first, n) == v, "_Digits_value");
+}
+
+void test_kernels(std::mt19937_64& g) {
+    for (int k = 0; k < 20000; ++k) {
+        const std::string s     = random_bytes(g, " \t\n\r\v\fabc0123456789\xC3\xA9{}");
+        const char*       first = s.data();
+        const char*       last  = first + s.size();
+
+        std::size_t spaces = 0, word = 0;
+        while (spaces < s.size() && _Is_space(static_cast<unsigned char>(s[spaces]))) { ++spaces; }
+        while (word < s.size() && !_Is_space(static_cast<unsigned char>(s[word]))) { ++word; }
+        expect(_Span_spaces<true>(first, last) == spaces, "_Span_spaces<true>");
+        expect(_Span_spaces<false>(first, last) == word, "_Span_spaces<false>");
+
+        _Scn_charset set;
+        for (auto n = g() % 40; n != 0; --n) { set.insert(static_cast<unsigned char>(g() % 3 ? s.empty() ? 'a' : s[g() % s.size()] : g())); }
+        std::size_t members = 0;
+        while (members < s.size() && set.test(static_cast<unsigned char>(s[members]))) { ++members; }
+        expect(_Span_charset(set, first, last) == members, "_Span_charset");
+
+        expect(_Valid_utf8(first, last) == _Valid_utf8_units(first, last), "_Valid_utf8");
+
+        const std::string other = g() % 2 ? s : random_bytes(g, "ab");
+        const std::size_t n     = std::min(s.size(), other.size());
+        std::size_t       same  = 0;
+        while (same < n && s[same] == other[same]) { ++same; }
+        expect(_Common_prefix(first, other.data(), n) == same, "_Common_prefix");
+
+        const std::string digits = random_bytes(g, "0123456789abcdef");
+        test_digit_kernels<10>(digits);
+        test_digit_kernels<16>(digits);
+        test_digit_kernels<8>(digits);
+        test_digit_kernels<2>(digits);
+    }
+}
+
+// scan_lines. Every driver has to produce the same columns, failures and errors as the string_view one.
+using line_columns = scan_columns<int, double, std::string>;
+
+bool same_errors(const scn::scan_error& a, const scn::scan_error& b) {
+    return a.code == b.code && a.offset == b.offset && a.field == b.field;
+}
+
+bool same_columns(const line_columns& a, const line_columns& b) {
+    return a.columns == b.columns && a.failed == b.failed && a.lines == b.lines &&
+           std::ranges::equal(a.errors, b.errors, same_errors);
+}
+
+std::string random_lines(std::mt19937_64& g, std::size_t lines) {
+    std::string text;
+    for (std::size_t k = 0; k < lines; ++k) {
+        text += std::to_string(static_cast<int>(g() % 2000000) - 1000000) + " ";
+        text += g() % 50 == 0 ? "x" : std::to_string(static_cast<double>(g() % 100000) / 64);
+        text += " ";
+        text += g() % 40 == 0 ? "" : "w" + std::to_string(g() % 1000);
+        text += g() % 20 == 0 ? "   \n" : "\n";
+    }
+    return text;
+}
+
+void test_scan_lines(std::mt19937_64& g) {
+    const std::string text = random_lines(g, 60000);
+    const auto        want = scan_lines<int, double, std::string>(std::string_view{ text }, "{} {} {}");
+    expect(want.lines == 60000 && !want.failed.empty(), "scan_lines over a string_view");
+
+    expect(same_columns(parallel_scan_lines<int, double, std::string>(text, "{} {} {}", 4), want), "parallel_scan_lines");
+
+    for (std::size_t block : { 1, 7, 64, 4096 }) {
+        std::istringstream      in{ text };
+        basic_scannable_istream stream{ in, block };
+        expect(same_columns(scan_lines<int, double, std::string>(stream, "{} {} {}"), want), "scan_lines over a stream");
+    }
+
+    line_columns each;
+    for (const auto& rec : std::string_view{ text } | scan_each<int, double, std::string>("{} {} {}")) {
+        if (rec) {
+            std::get<0>(each.columns).push_back(std::get<0>(*rec));
+            std::get<1>(each.columns).push_back(std::get<1>(*rec));
+            std::get<2>(each.columns).push_back(std::get<2>(*rec));
+        }
+        else {
+            each.failed.push_back(each.lines);
+            each.errors.push_back(rec.error());
+        }
+        ++each.lines;
+    }
+    expect(same_columns(each, want), "scan_each");
+
+    line_columns                            fed;
+    scan_feeder<int, double, std::string>   feeder{ "{} {} {}" };
+    bool                                    finished = false;
+    for (std::size_t at = 0;;) {
+        auto res = feeder.next();
+        if (res && *res) {
+            std::get<0>(fed.columns).push_back(std::get<0>(feeder.values()));
+            std::get<1>(fed.columns).push_back(std::get<1>(feeder.values()));
+            std::get<2>(fed.columns).push_back(std::get<2>(feeder.values()));
+            ++fed.lines;
+        }
+        else if (!res) {
+            fed.failed.push_back(fed.lines++);
+            fed.errors.push_back(res.error());
+        }
+        else if (at != text.size()) {
+            // Chunks of any size, most of them ending inside a record.
+            const std::size_t n = std::min<std::size_t>(1 + g() % 300, text.size() - at);
+            feeder.feed(std::span{ text.data() + at, n });
+            at += n;
+        }
+        else if (!finished) { feeder.finish(); finished = true; }
+        else                { break; }
+    }
+    expect(same_columns(fed, want), "scan_feeder");
+}
+
+} // namespace
+
+int main() {
+    std::mt19937_64 g{ 1729 };
+
+    test_runtime_lowering();
+    test_integers<int>(g);
+    test_integers<unsigned>(g);
+    test_integers<std::int64_t>(g);
+    test_integers<std::uint64_t>(g);
+    test_integers<std::int8_t>(g);
+    test_integers<std::uint16_t>(g);
+    test_float_parity<double>(g, 20000);
+    test_float_parity<float>(g, 20000);
+    test_kernels(g);
+    test_scan_lines(g);
+
+    std::printf("%s, %d failed checks\n", failures ? "FAILED" : "passed", failures);
+    return std::min(failures, 255);
+}